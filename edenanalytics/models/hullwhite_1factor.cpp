@@ -1,5 +1,6 @@
 
 #include "hullwhite_1factor.h"
+#include "parallel.h"
 
 using namespace edenanalytics;
 
@@ -30,6 +31,40 @@ std::vector<double> HullWhiteModel1F::simulateShortRate(double r0, double dt, in
     return rates;
 }
 
+std::vector<std::vector<double>> HullWhiteModel1F::simulateShortRatePaths(
+    eden::IThreadExecutor& executor, double r0, double dt, int numSteps, int numPaths, std::uint64_t seed) const {
+    if (numSteps <= 0 || numPaths <= 0) {
+        throw std::invalid_argument("simulateShortRatePaths: numSteps and numPaths must be positive");
+    }
+
+    // theta(t) is the same for every path, compute it once
+    std::vector<double> thetas(numSteps);
+    for (int i = 1; i < numSteps; ++i) {
+        thetas[i] = calculateTheta(i * dt);
+    }
+
+    std::vector<std::vector<double>> paths(numPaths);
+    eden::parallel_for(executor, 0, numPaths, [&](int p) {
+        // seed_seq keeps 32 bits per element: the seed goes in as two words
+        std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                          static_cast<std::uint32_t>(p)};
+        std::mt19937_64 generator(seq);
+        std::normal_distribution<double> distribution(0.0, 1.0);
+        const double sqrtDt = std::sqrt(dt);
+
+        std::vector<double> rates(numSteps);
+        rates[0] = r0;
+        for (int i = 1; i < numSteps; ++i) {
+            double dw = distribution(generator) * sqrtDt;
+            double dr = (thetas[i] - alpha_ * rates[i - 1]) * dt + sigma_ * dw;
+            rates[i] = rates[i - 1] + dr;
+        }
+        paths[p] = std::move(rates);
+    });
+
+    return paths;
+}
+
 // Calculate bond price analytically in the Hull-White model
 double HullWhiteModel1F::bondPrice(double r0, double t, double T) {
     double B0T = std::exp(-initialTermStructure_.value(T) * T);
@@ -13,6 +13,10 @@
 
 #include "core/yieldcurve.h"
 
+namespace eden {
+struct IThreadExecutor;
+}
+
 namespace edenanalytics {
 
 /**
@@ -64,6 +68,13 @@ public:
     // Simulate short rate using the Euler-Maruyama method
     std::vector<double> simulateShortRate(double r0, double dt, int numSteps);
 
+    // Simulate numPaths independent paths in parallel on the executor.
+    // Path p draws from its own generator seeded with (seed, p): the paths do not
+    // depend on the executor nor on its number of threads.
+    // Throws std::invalid_argument when numSteps or numPaths is not positive.
+    std::vector<std::vector<double>> simulateShortRatePaths(
+        eden::IThreadExecutor& executor, double r0, double dt, int numSteps, int numPaths, std::uint64_t seed) const;
+
     // Calculate bond price analytically in the Hull-White model
     double bondPrice(double r0, double t, double T);
 
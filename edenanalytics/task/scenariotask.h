@@ -15,6 +15,10 @@ public:
 
     const std::string& getScenario() const { return scenario_; }
 
+    Fingerprint fingerprint() const override {
+        return Hasher(Attributes::fingerprint()).add(scenario_).value();
+    }
+
 private:
     std::string scenario_;
 };
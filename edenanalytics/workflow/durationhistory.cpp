@@ -0,0 +1,87 @@
+#include "durationhistory.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <typeinfo>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+namespace eden {
+
+DurationHistory::DurationHistory(double smoothing) : smoothing_(smoothing) {
+    if (!(smoothing > 0.0 && smoothing <= 1.0)) {
+        throw std::invalid_argument("DurationHistory: smoothing must be in (0, 1]");
+    }
+}
+
+std::string DurationHistory::typeOf(const ITask& task) {
+    const char* name = typeid(task).name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    if (char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status)) {
+        std::string type(demangled);
+        std::free(demangled);
+        return type;
+    }
+#endif
+    return name;
+}
+
+void DurationHistory::record(const std::string& taskType, Duration elapsed) {
+    const auto ns = static_cast<double>(elapsed.count());
+    std::lock_guard lock(mutex_);
+    auto& entry = entries_[taskType];
+    entry.meanNs = entry.samples == 0 ? ns : entry.meanNs + smoothing_ * (ns - entry.meanNs);
+    ++entry.samples;
+}
+
+std::optional<DurationHistory::Duration> DurationHistory::estimate(const std::string& taskType) const {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(taskType);
+    if (it == entries_.end()) return std::nullopt;
+    return Duration(static_cast<Duration::rep>(it->second.meanNs));
+}
+
+std::size_t DurationHistory::samples(const std::string& taskType) const {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(taskType);
+    return it == entries_.end() ? 0 : it->second.samples;
+}
+
+std::size_t DurationHistory::size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+void DurationHistory::save(const std::string& filepath) const {
+    nlohmann::json data = nlohmann::json::object();
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& [type, entry] : entries_) {
+            data[type] = {{"mean_ns", entry.meanNs}, {"samples", entry.samples}};
+        }
+    }
+
+    std::ofstream out(filepath);
+    if (!out) throw std::runtime_error("Cannot open file: " + filepath);
+    out << std::setw(4) << data;
+}
+
+void DurationHistory::load(const std::string& filepath) {
+    std::ifstream in(filepath);
+    if (!in) throw std::runtime_error("Cannot open file: " + filepath);
+
+    nlohmann::json data;
+    in >> data;
+
+    std::lock_guard lock(mutex_);
+    for (const auto& [type, value] : data.items()) {
+        entries_[type] = Entry{value.at("mean_ns").get<double>(), value.at("samples").get<std::size_t>()};
+    }
+}
+
+} // namespace eden
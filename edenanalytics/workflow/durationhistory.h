@@ -0,0 +1,60 @@
+#pragma once
+
+#include "itask.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace eden {
+
+/**
+ * @brief Run durations per task type, kept across runs
+ * @details The task type is the task's concrete class (typeOf(): "eden::FetchDataTask",
+ * "eden::ComputePresentValueTask", ...), so every instance of a type shares one
+ * estimate whatever its name. Each type keeps an exponentially weighted mean of
+ * its measured durations, so a slow day moves the estimate without erasing the
+ * history. The first sample sets the estimate directly.
+ *
+ * Workflow::run records into it and reads it back to rank ready tasks by the
+ * longest remaining path. save()/load() keep it between processes (JSON).
+ * Thread-safe: tasks finishing on different workers record concurrently.
+ */
+class DurationHistory {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    // weight of a new sample in the mean, in (0, 1]
+    explicit DurationHistory(double smoothing = 0.3);
+
+    // Key under which Workflow::run records a task: its concrete type, demangled
+    // where the compiler allows it
+    [[nodiscard]] static std::string typeOf(const ITask& task);
+
+    void record(const std::string& taskType, Duration elapsed);
+
+    [[nodiscard]] std::optional<Duration> estimate(const std::string& taskType) const;
+    [[nodiscard]] std::size_t samples(const std::string& taskType) const;
+    [[nodiscard]] std::size_t size() const;
+
+    // Throws std::runtime_error when the file cannot be opened
+    void save(const std::string& filepath) const;
+    void load(const std::string& filepath);
+
+private:
+    struct Entry {
+        double meanNs = 0.0;
+        std::size_t samples = 0;
+    };
+
+    double smoothing_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+using DurationHistorySPtr = std::shared_ptr<DurationHistory>;
+
+} // namespace eden
@@ -0,0 +1,229 @@
+#include "executionplan.h"
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+namespace eden {
+
+ExecutionPlan::ExecutionPlan(const std::unordered_map<TaskID, TaskSPtr>& tasks,
+                             const std::unordered_map<TaskID, std::vector<TaskID>>& deps,
+                             bool reduce) {
+    // 1) Provisional indices in id order, so that the plan does not depend on hashing
+    std::vector<TaskID> ids;
+    ids.reserve(tasks.size());
+    for (const auto& [id, _] : tasks) ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+
+    std::unordered_map<TaskID, Index> provisional;
+    provisional.reserve(ids.size());
+    for (Index i = 0; i < ids.size(); ++i) provisional.emplace(ids[i], i);
+
+    const auto lookup = [&](TaskID id) {
+        auto it = provisional.find(id);
+        if (it == provisional.end()) throw std::runtime_error(std::format("Unknown task: {}", id));
+        return it->second;
+    };
+
+    std::vector<std::vector<Index>> children(ids.size());
+    for (const auto& [after, befores] : deps) {
+        const Index a = lookup(after);
+        for (const auto& before : befores) {
+            children[lookup(before)].push_back(a);  // 'before' must run before 'after'
+        }
+    }
+
+    // 2) Topological order (Kahn), which also detects cycles
+    std::vector<std::uint32_t> degree(ids.size(), 0);
+    for (const auto& list : children) {
+        for (Index c : list) ++degree[c];
+    }
+    std::vector<Index> order;
+    order.reserve(ids.size());
+    for (Index i = 0; i < ids.size(); ++i) {
+        if (degree[i] == 0) order.push_back(i);
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        for (Index c : children[order[head]]) {
+            if (--degree[c] == 0) order.push_back(c);
+        }
+    }
+    if (order.size() != ids.size()) throw std::runtime_error("Workflow has a dependency cycle");
+
+    // 3) Final indices follow the topological order: every edge goes from low to high
+    std::vector<Index> rank(ids.size());
+    for (Index pos = 0; pos < order.size(); ++pos) rank[order[pos]] = pos;
+
+    std::vector<std::vector<Index>> ranked(ids.size());
+    ids_.resize(ids.size());
+    tasks_.resize(ids.size());
+    indices_.reserve(ids.size());
+    for (Index i = 0; i < ids.size(); ++i) {
+        const Index r = rank[i];
+        ids_[r] = ids[i];
+        tasks_[r] = tasks.at(ids[i]);
+        indices_.emplace(ids[i], r);
+
+        auto& list = ranked[r];
+        list.reserve(children[i].size());
+        for (Index c : children[i]) list.push_back(rank[c]);
+        std::sort(list.begin(), list.end());
+        const auto duplicates = std::unique(list.begin(), list.end());
+        removedEdges_ += static_cast<std::size_t>(list.end() - duplicates);
+        list.erase(duplicates, list.end());
+    }
+
+    if (reduce) reduceEdges(ranked);
+
+    // 4) CSR arrays and in-degrees
+    offsets_.assign(ids_.size() + 1, 0);
+    inDegree_.assign(ids_.size(), 0);
+    for (Index i = 0; i < ranked.size(); ++i) {
+        offsets_[i + 1] = offsets_[i] + static_cast<std::uint32_t>(ranked[i].size());
+    }
+    targets_.reserve(offsets_.back());
+    for (const auto& list : ranked) {
+        for (Index c : list) {
+            targets_.push_back(c);
+            ++inDegree_[c];
+        }
+    }
+    for (Index i = 0; i < ids_.size(); ++i) {
+        if (inDegree_[i] == 0) roots_.push_back(i);
+    }
+
+    // 5) Links of linear chains
+    fusedChild_.assign(ids_.size(), kNoTask);
+    for (Index i = 0; i < ids_.size(); ++i) {
+        const auto& list = ranked[i];
+        if (list.size() == 1 && inDegree_[list.front()] == 1) {
+            fusedChild_[i] = list.front();
+            ++fusedEdges_;
+        }
+    }
+}
+
+/*
+Transitive reduction on a topologically indexed DAG:
+the edge u -> v is redundant when v is reachable from another child of u. For each u
+with several children, a DFS from its children marks what they reach; children hit by
+that DFS lose their edge from u. Indices only grow along a path, so the DFS never
+needs to go past u's highest child. Stamps (u + 1) avoid clearing the marks between nodes.
+*/
+void ExecutionPlan::reduceEdges(std::vector<std::vector<Index>>& children) {
+    const std::size_t n = children.size();
+    std::vector<Index> childOf(n, 0);
+    std::vector<Index> visited(n, 0);
+    std::vector<Index> stack;
+
+    for (Index u = 0; u < n; ++u) {
+        auto& list = children[u];
+        if (list.size() < 2) continue;
+
+        const Index stamp = u + 1;
+        const Index highest = list.back();  // sorted
+        for (Index c : list) childOf[c] = stamp;
+
+        bool redundant = false;
+        for (Index c : list) {
+            for (Index g : children[c]) {
+                if (g <= highest && visited[g] != stamp) {
+                    visited[g] = stamp;
+                    stack.push_back(g);
+                }
+            }
+        }
+        while (!stack.empty()) {
+            const Index x = stack.back();
+            stack.pop_back();
+            if (childOf[x] == stamp) {
+                // Reached through a sibling: u -> x is implied
+                childOf[x] = 0;
+                redundant = true;
+            }
+            for (Index g : children[x]) {
+                if (g <= highest && visited[g] != stamp) {
+                    visited[g] = stamp;
+                    stack.push_back(g);
+                }
+            }
+        }
+
+        if (redundant) {
+            const auto kept = std::remove_if(list.begin(), list.end(), [&](Index c) { return childOf[c] != stamp; });
+            removedEdges_ += static_cast<std::size_t>(list.end() - kept);
+            list.erase(kept, list.end());
+        }
+    }
+}
+
+std::vector<std::chrono::nanoseconds> ExecutionPlan::bottomLevels(
+    std::span<const std::chrono::nanoseconds> cost) const {
+    // Children always have higher indices: one backward sweep sees them first
+    std::vector<std::chrono::nanoseconds> level(size());
+    for (std::size_t i = size(); i-- > 0;) {
+        std::chrono::nanoseconds longest{0};
+        for (Index c : children(static_cast<Index>(i))) longest = std::max(longest, level[c]);
+        level[i] = cost[i] + longest;
+    }
+    return level;
+}
+
+std::vector<std::uint8_t> ExecutionPlan::ancestors(std::span<const Index> tasks) const {
+    // Children always have higher indices: a backward sweep sees a task's children
+    // before the task. The reduced graph keeps every ancestor reachable.
+    std::vector<std::uint8_t> marked(size(), 0);
+    for (Index t : tasks) marked[t] = 1;
+    for (std::size_t i = size(); i-- > 0;) {
+        if (marked[i]) continue;
+        for (Index c : children(static_cast<Index>(i))) {
+            if (marked[c]) {
+                marked[i] = 1;
+                break;
+            }
+        }
+    }
+    return marked;
+}
+
+std::vector<Fingerprint> ExecutionPlan::fingerprints(const AttributeSPtr& attrs, const ContextSPtr& ctx) const {
+    // Upstream fingerprints are summed after mixing, so the result does not depend on
+    // the order of the parents. The reduced graph keeps every ancestor reachable.
+    std::vector<Fingerprint> upstream(size(), 0);
+    std::vector<Fingerprint> combined(size());
+    for (Index i = 0; i < size(); ++i) {
+        combined[i] = Hasher(task(i).fingerprint(attrs, ctx)).add(upstream[i]).value();
+        const Fingerprint mixed = Hasher().add(combined[i]).value();
+        for (Index c : children(i)) upstream[c] += mixed;
+    }
+    return combined;
+}
+
+ExecutionPlan::Counters::Counters(const ExecutionPlan& plan)
+    : plan_(plan), remaining_(std::make_unique<Counter[]>(plan.size())) {
+    reset();
+}
+
+void ExecutionPlan::Counters::reset() noexcept {
+    for (Index i = 0; i < plan_.size(); ++i) {
+        remaining_[i].value.store(plan_.inDegree(i), std::memory_order_relaxed);
+    }
+}
+
+std::vector<ExecutionPlan::Index> ExecutionPlan::Counters::reset(std::span<const std::uint8_t> selected) {
+    std::vector<std::uint32_t> waiting(plan_.size(), 0);
+    for (Index i = 0; i < plan_.size(); ++i) {
+        if (!selected[i]) continue;
+        for (Index c : plan_.children(i)) {
+            if (selected[c]) ++waiting[c];
+        }
+    }
+
+    std::vector<Index> roots;
+    for (Index i = 0; i < plan_.size(); ++i) {
+        remaining_[i].value.store(waiting[i], std::memory_order_relaxed);
+        if (selected[i] && waiting[i] == 0) roots.push_back(i);
+    }
+    return roots;
+}
+
+} // namespace eden
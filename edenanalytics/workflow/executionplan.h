@@ -0,0 +1,124 @@
+#pragma once
+
+#include "itask.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Compiled, reusable form of a workflow's dependency graph
+ * @details Built once by Workflow::compile(). Tasks get dense indices (in a
+ * topological order), children are stored as CSR arrays (offsets + targets) and the
+ * unresolved-dependency counters live in one flat array, one cache line each, so the
+ * completion path is an array walk and an atomic decrement: no hashing, no allocation.
+ *
+ * Redundant edges are dropped (transitive reduction): if a -> b -> c, the edge a -> c
+ * adds nothing to the ordering and only costs a decrement. Duplicate edges go too.
+ *
+ * Single-parent, single-child links are marked for fusion (fusedChild()): a run
+ * executes such a chain back to back in one job, still task by task.
+ *
+ * The plan itself never changes once built, so concurrent runs share it; each run
+ * keeps its own Counters, reloaded from the in-degrees.
+ */
+class ExecutionPlan {
+public:
+    using Index = std::uint32_t;
+    static constexpr Index kNoTask = ~Index{0};
+
+    // Throws std::runtime_error on an unknown task or a dependency cycle
+    ExecutionPlan(const std::unordered_map<TaskID, TaskSPtr>& tasks,
+                  const std::unordered_map<TaskID, std::vector<TaskID>>& deps,
+                  bool reduce = true);
+
+    ExecutionPlan(const ExecutionPlan&) = delete;
+    ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept { return ids_.size(); }
+    [[nodiscard]] std::size_t edgeCount() const noexcept { return targets_.size(); }
+    // Edges removed by the transitive reduction (duplicates included)
+    [[nodiscard]] std::size_t removedEdges() const noexcept { return removedEdges_; }
+
+    [[nodiscard]] TaskID idOf(Index index) const noexcept { return ids_[index]; }
+    [[nodiscard]] ITask& task(Index index) const noexcept { return *tasks_[index]; }
+    // Throws std::out_of_range for an unknown id
+    [[nodiscard]] Index indexOf(TaskID id) const { return indices_.at(id); }
+
+    [[nodiscard]] std::span<const Index> children(Index index) const noexcept {
+        return {targets_.data() + offsets_[index], targets_.data() + offsets_[index + 1]};
+    }
+    [[nodiscard]] std::uint32_t inDegree(Index index) const noexcept { return inDegree_[index]; }
+    // Tasks without dependencies
+    [[nodiscard]] std::span<const Index> roots() const noexcept { return roots_; }
+
+    // Fusion of linear chains: when index has a single child, and that child no other
+    // parent, the child can run right after it in the same job (no executor round
+    // trip, its input still in cache). kNoTask otherwise.
+    [[nodiscard]] Index fusedChild(Index index) const noexcept { return fusedChild_[index]; }
+    // Edges fused that way
+    [[nodiscard]] std::size_t fusedEdges() const noexcept { return fusedEdges_; }
+
+    // Longest path from each task to the end of the graph, its own cost included
+    // (the "bottom level"); cost is indexed like the plan
+    [[nodiscard]] std::vector<std::chrono::nanoseconds> bottomLevels(
+        std::span<const std::chrono::nanoseconds> cost) const;
+
+    // The given tasks and everything upstream of them: mask indexed like the plan
+    [[nodiscard]] std::vector<std::uint8_t> ancestors(std::span<const Index> tasks) const;
+
+    // Fingerprint of every task's own inputs mixed with those of its upstream tasks
+    // (ITask::fingerprint), indexed like the plan
+    [[nodiscard]] std::vector<Fingerprint> fingerprints(const AttributeSPtr& attrs, const ContextSPtr& ctx) const;
+
+    /// Unresolved dependencies of every task, for one run
+    class Counters {
+    public:
+        explicit Counters(const ExecutionPlan& plan);
+
+        // Reload every counter from the in-degrees
+        void reset() noexcept;
+
+        // Run only part of the graph: selected[i] != 0 keeps task i, which then waits
+        // for its selected parents only. Returns the selected tasks that wait for none.
+        // The caller must not release a task that is not selected.
+        std::vector<Index> reset(std::span<const std::uint8_t> selected);
+
+        // One dependency of index is done; true when it was the last one (index is ready)
+        bool release(Index index) noexcept {
+            return remaining_[index].value.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+    private:
+        // One counter per cache line: tasks finishing on different cores never share a line
+        struct alignas(64) Counter {
+            std::atomic<std::uint32_t> value{0};
+        };
+
+        const ExecutionPlan& plan_;
+        std::unique_ptr<Counter[]> remaining_;
+    };
+
+private:
+    void reduceEdges(std::vector<std::vector<Index>>& children);
+
+    std::vector<TaskID> ids_;
+    std::vector<TaskSPtr> tasks_;
+    std::unordered_map<TaskID, Index> indices_;
+    // CSR adjacency: the children of i are targets_[offsets_[i] .. offsets_[i + 1])
+    std::vector<std::uint32_t> offsets_;
+    std::vector<Index> targets_;
+    std::vector<std::uint32_t> inDegree_;
+    std::vector<Index> roots_;
+    std::vector<Index> fusedChild_;
+    std::size_t removedEdges_ = 0;
+    std::size_t fusedEdges_ = 0;
+};
+
+} // namespace eden
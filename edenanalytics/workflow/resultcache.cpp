@@ -0,0 +1,184 @@
+#include "resultcache.h"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+namespace eden {
+
+namespace {
+
+constexpr std::string_view kExtension = ".result";
+
+std::optional<Fingerprint> parseKey(const std::filesystem::path& file) {
+    if (file.extension() != kExtension) return std::nullopt;
+    const std::string stem = file.stem().string();
+    if (stem.size() != 16) return std::nullopt;
+    try {
+        std::size_t used = 0;
+        const auto key = std::stoull(stem, &used, 16);
+        if (used != stem.size()) return std::nullopt;
+        return key;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+ResultCache::ResultCache(std::filesystem::path directory, std::uintmax_t maxBytes)
+    : directory_(std::move(directory)), maxBytes_(maxBytes) {
+    std::filesystem::create_directories(directory_);
+
+    // Oldest first, so that pushing to the front leaves the most recent at the front
+    struct Found {
+        Fingerprint key;
+        std::uintmax_t size;
+        std::filesystem::file_time_type touched;
+    };
+    std::vector<Found> found;
+    for (const auto& item : std::filesystem::directory_iterator(directory_)) {
+        if (!item.is_regular_file()) continue;
+        if (auto key = parseKey(item.path())) {
+            found.push_back({*key, item.file_size(), item.last_write_time()});
+        }
+    }
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.touched < b.touched; });
+
+    std::vector<Fingerprint> evicted;
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& f : found) {
+            lru_.push_front(f.key);
+            entries_.emplace(f.key, Entry{f.size, lru_.begin()});
+            bytes_ += f.size;
+        }
+        evicted = evict();
+    }
+    removeFiles(evicted);
+}
+
+std::filesystem::path ResultCache::pathOf(Fingerprint key) const {
+    return directory_ / std::format("{:016x}{}", key, kExtension);
+}
+
+std::optional<std::string> ResultCache::get(Fingerprint key) {
+    {
+        std::lock_guard lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++counters_.misses;
+            return std::nullopt;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second.position);
+    }
+
+    const auto path = pathOf(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        // Evicted by another process in the meantime
+        std::lock_guard lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            bytes_ -= it->second.size;
+            lru_.erase(it->second.position);
+            entries_.erase(it);
+        }
+        ++counters_.misses;
+        return std::nullopt;
+    }
+
+    std::string bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::error_code ignored;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ignored);
+
+    std::lock_guard lock(mutex_);
+    ++counters_.hits;
+    return bytes;
+}
+
+void ResultCache::put(Fingerprint key, std::string_view bytes) {
+    if (bytes.size() > maxBytes_) return;
+    if (contains(key)) return;
+
+    const auto temp = directory_ / std::format("{:016x}.{}.tmp", key, tempSequence_.fetch_add(1));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            return;  // a full disk makes the cache useless, not the run
+        }
+    }
+
+    // Atomic, and the content is the same whoever wins a concurrent store
+    std::error_code error;
+    std::filesystem::rename(temp, pathOf(key), error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return;
+    }
+
+    std::vector<Fingerprint> evicted;
+    {
+        std::lock_guard lock(mutex_);
+        ++counters_.stores;
+        if (entries_.contains(key)) return;  // stored twice concurrently, same content
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{bytes.size(), lru_.begin()});
+        bytes_ += bytes.size();
+        evicted = evict();
+    }
+    removeFiles(evicted);
+}
+
+bool ResultCache::contains(Fingerprint key) const {
+    std::lock_guard lock(mutex_);
+    return entries_.contains(key);
+}
+
+void ResultCache::clear() {
+    std::vector<Fingerprint> removed;
+    {
+        std::lock_guard lock(mutex_);
+        removed.assign(lru_.begin(), lru_.end());
+        lru_.clear();
+        entries_.clear();
+        bytes_ = 0;
+    }
+    removeFiles(removed);
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard lock(mutex_);
+    Stats stats = counters_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+std::vector<Fingerprint> ResultCache::evict() {
+    std::vector<Fingerprint> evicted;
+    while (bytes_ > maxBytes_ && !lru_.empty()) {
+        const Fingerprint key = lru_.back();
+        lru_.pop_back();
+        auto it = entries_.find(key);
+        bytes_ -= it->second.size;
+        entries_.erase(it);
+        evicted.push_back(key);
+        ++counters_.evictions;
+    }
+    return evicted;
+}
+
+// A file stored again since its key was dropped may go too: get() then treats it
+// as evicted by another process
+void ResultCache::removeFiles(const std::vector<Fingerprint>& keys) const {
+    std::error_code ignored;
+    for (Fingerprint key : keys) std::filesystem::remove(pathOf(key), ignored);
+}
+
+} // namespace eden
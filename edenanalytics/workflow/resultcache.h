@@ -0,0 +1,86 @@
+#pragma once
+
+#include "hash.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Content-addressed task results on local disk
+ * @details One file per entry, named after its key: the fingerprint of everything
+ * the result depends on (task type, attributes, the task's context keys, upstream
+ * fingerprints). Equal keys mean equal results, so entries are never updated, only
+ * added and evicted.
+ *
+ * The total size is bounded: the least recently used entries are removed once it
+ * goes over maxBytes. Recency survives restarts through the files' modification
+ * times, which get() refreshes. Several workflows and processes may share one
+ * directory; files are written to a temporary name first and renamed into place.
+ *
+ * Thread-safe. The internal lock only guards the index: file reads, writes, renames
+ * and removals all happen outside it.
+ */
+class ResultCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t stores = 0;
+        std::uint64_t evictions = 0;
+        std::size_t entries = 0;
+        std::uintmax_t bytes = 0;
+    };
+
+    // Creates the directory if needed and indexes the entries already there.
+    // Throws std::filesystem::filesystem_error when the directory cannot be created.
+    ResultCache(std::filesystem::path directory, std::uintmax_t maxBytes);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    [[nodiscard]] std::optional<std::string> get(Fingerprint key);
+    // An entry larger than maxBytes is not kept
+    void put(Fingerprint key, std::string_view bytes);
+    [[nodiscard]] bool contains(Fingerprint key) const;
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+    [[nodiscard]] const std::filesystem::path& directory() const noexcept { return directory_; }
+    [[nodiscard]] std::uintmax_t maxBytes() const noexcept { return maxBytes_; }
+
+private:
+    struct Entry {
+        std::uintmax_t size = 0;
+        std::list<Fingerprint>::iterator position;  // in lru_, most recent first
+    };
+
+    std::filesystem::path pathOf(Fingerprint key) const;
+    // Under mutex_: drop least recently used entries from the index until the total
+    // fits; returns their keys, for removeFiles() once the lock is released
+    [[nodiscard]] std::vector<Fingerprint> evict();
+    void removeFiles(const std::vector<Fingerprint>& keys) const;
+
+    std::filesystem::path directory_;
+    std::uintmax_t maxBytes_;
+
+    mutable std::mutex mutex_;
+    std::list<Fingerprint> lru_;
+    std::unordered_map<Fingerprint, Entry> entries_;
+    std::uintmax_t bytes_ = 0;
+    Stats counters_;
+    std::atomic<std::uint64_t> tempSequence_{0};
+};
+
+using ResultCacheSPtr = std::shared_ptr<ResultCache>;
+
+} // namespace eden
@@ -0,0 +1,70 @@
+#include "runjournal.h"
+#include <stdexcept>
+
+#include <nlohmann/json.hpp>
+
+namespace eden {
+
+void RunJournal::start(const std::string& workflow) {
+    std::lock_guard lock(mutex_);
+    out_.close();
+    out_.open(path_, std::ios::out | std::ios::trunc);
+    if (!out_) throw std::runtime_error("Cannot open journal: " + path_.string());
+    out_ << nlohmann::json{{"workflow", workflow}}.dump() << '\n' << std::flush;
+}
+
+void RunJournal::reopen() {
+    std::lock_guard lock(mutex_);
+    out_.close();
+    dropTornLine();
+    out_.open(path_, std::ios::out | std::ios::app);
+    if (!out_) throw std::runtime_error("Cannot open journal: " + path_.string());
+}
+
+void RunJournal::dropTornLine() {
+    std::ifstream in(path_, std::ios::binary);
+    if (!in) return;
+    in.seekg(0, std::ios::end);
+    const auto size = static_cast<std::uintmax_t>(in.tellg());
+
+    // Walk back to the last complete line; everything after it was cut short by a crash
+    std::uintmax_t keep = size;
+    while (keep > 0) {
+        in.seekg(static_cast<std::streamoff>(keep - 1));
+        if (in.get() == '\n') break;
+        --keep;
+    }
+    in.close();
+    if (keep != size) std::filesystem::resize_file(path_, keep);
+}
+
+void RunJournal::completed(const Entry& entry) {
+    nlohmann::json line{{"task", entry.task}, {"fingerprint", entry.fingerprint}};
+    if (entry.result) line["result"] = *entry.result;
+    const std::string text = line.dump();
+
+    std::lock_guard lock(mutex_);
+    out_ << text << '\n' << std::flush;
+}
+
+std::unordered_map<TaskID, RunJournal::Entry> RunJournal::load(const std::filesystem::path& path) {
+    std::unordered_map<TaskID, Entry> entries;
+    std::ifstream in(path);
+    if (!in) return entries;
+
+    std::string text;
+    while (std::getline(in, text)) {
+        const auto line = nlohmann::json::parse(text, nullptr, false);
+        // Header, or a line cut short by a crash
+        if (line.is_discarded() || !line.contains("task")) continue;
+
+        Entry entry;
+        entry.task = line.at("task").get<TaskID>();
+        entry.fingerprint = line.at("fingerprint").get<Fingerprint>();
+        if (line.contains("result")) entry.result = line.at("result").get<Fingerprint>();
+        entries[entry.task] = entry;
+    }
+    return entries;
+}
+
+} // namespace eden
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "hash.h"
+#include "itask.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace eden {
+
+/**
+ * @brief Append-only record of the tasks completed by a workflow run
+ * @details One JSON object per line, written and flushed as each task finishes:
+ * the task id, its input fingerprint and, when its result went to the result cache,
+ * the cache key (the output reference). A crash loses at most the line being written;
+ * load() ignores a torn last line.
+ *
+ * Workflow::run starts a new journal, Workflow::resume reads it back and appends to it.
+ */
+class RunJournal {
+public:
+    struct Entry {
+        TaskID task = 0;
+        Fingerprint fingerprint = 0;
+        std::optional<Fingerprint> result;
+    };
+
+    explicit RunJournal(std::filesystem::path path) : path_(std::move(path)) {}
+
+    RunJournal(const RunJournal&) = delete;
+    RunJournal& operator=(const RunJournal&) = delete;
+
+    // Truncate the file and write the header line.
+    // Both throw std::runtime_error when the file cannot be opened.
+    void start(const std::string& workflow);
+    // Keep the existing entries and append after them, dropping a torn last line first
+    // so that the next entry does not get glued onto it
+    void reopen();
+
+    // Thread-safe: tasks finish on any worker
+    void completed(const Entry& entry);
+
+    // Latest entry per task; empty when the file does not exist
+    [[nodiscard]] static std::unordered_map<TaskID, Entry> load(const std::filesystem::path& path);
+
+    [[nodiscard]] const std::filesystem::path& path() const noexcept { return path_; }
+
+private:
+    void dropTornLine();
+
+    std::filesystem::path path_;
+    std::mutex mutex_;
+    std::ofstream out_;
+};
+
+} // namespace eden
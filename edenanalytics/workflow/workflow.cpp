@@ -2,6 +2,8 @@
 #include "task/fetchdatatask.h"
 #include <stdexcept>
 #include <algorithm>
+#include <format>
+#include <mutex>
 
 #include <nlohmann/json.hpp>
 // #include <imgui.h>
@@ -28,6 +30,8 @@ void Workflow::exportGraphviz(std::ostream& os) const {
                 color = "orange"; break;
             case ITask::Status::Failed:
                 color = "red"; break;
+            case ITask::Status::Skipped:
+                color = "gray"; break;
             default:
                 break;
         }
@@ -45,74 +49,165 @@ void Workflow::exportGraphviz(std::ostream& os) const {
     os << "}\n";
 }
 
+Workflow::~Workflow() {
+    // Jobs of the runs still in flight use the workflow until their run completes
+    for (int active = activeRuns_.load(std::memory_order_acquire); active != 0;
+         active = activeRuns_.load(std::memory_order_acquire)) {
+        activeRuns_.wait(active, std::memory_order_acquire);
+    }
+}
+
+std::shared_ptr<const ExecutionPlan> Workflow::compile() {
+    std::lock_guard lock(planMutex_);
+    if (!plan_) {
+        plan_ = std::make_shared<const ExecutionPlan>(tasks_, deps_);
+        std::cout << "Workflow::compile() - " << plan_->size() << " tasks, " << plan_->edgeCount()
+                  << " edges (" << plan_->removedEdges() << " redundant dropped, " << plan_->fusedEdges()
+                  << " fused)\n";
+    }
+    return plan_;
+}
+
 void Workflow::run(IThreadExecutor& executor) {
-    std::cout << ">>> Workflow::run() started\n";
+    finish(*launch(executor, nullptr));
+}
 
-    // 1) Build the dependency graph: children_ and remaining_
-    children_.clear();
-    remaining_.clear();
+WorkflowRunSPtr Workflow::runAsync(IThreadExecutor& executor) {
+    return launch(executor, nullptr);
+}
 
-    // Initialize all task entries
-    for (const auto& [id, _] : tasks_) {
-        children_[id] = {};  // no children yet
-        remaining_[id].store(0, std::memory_order_relaxed);  // no unresolved dependencies
-    }
+void Workflow::run(IThreadExecutor& executor, const RunTargets& targets) {
+    finish(*runAsync(executor, targets));
+}
 
-    // Process dependency links: populate children and count dependencies
-    for (const auto& [after, befores] : deps_) {
-        std::cout << after << " depends on: ";
-        for (const auto& b : befores)
-            std::cout << b << " ";
-        std::cout << "\n";
+WorkflowRunSPtr Workflow::runAsync(IThreadExecutor& executor, const RunTargets& targets) {
+    const auto scope = scopeOf(*compile(), targets);
+    return launch(executor, nullptr, &scope);
+}
 
-        if (!tasks_.count(after)) throw std::runtime_error(std::format("Unknown task: {}", after));
-        for (const auto& before : befores) {
-            if (!tasks_.count(before)) throw std::runtime_error(std::format("Unknown task: {}", before));
-            children_[before].push_back(after);  // 'before' must run before 'after'
-            remaining_[after].fetch_add(1, std::memory_order_relaxed);  // increment dependency count
+WorkflowRun::Scope Workflow::scopeOf(const ExecutionPlan& plan, const RunTargets& targets) const {
+    if (targets.tasks.empty() && targets.outputs.empty()) {
+        throw std::invalid_argument("Workflow::run() - no target");
+    }
+    std::vector<ExecutionPlan::Index> wanted;
+    for (TaskID id : targets.tasks) wanted.push_back(plan.indexOf(id));
+    for (int output : targets.outputs) {
+        const auto before = wanted.size();
+        for (ExecutionPlan::Index i = 0; i < plan.size(); ++i) {
+            if (plan.task(i).outputID() == output) wanted.push_back(i);
+        }
+        if (wanted.size() == before) {
+            throw std::invalid_argument(std::format("Workflow::run() - no task produces output {}", output));
         }
     }
 
-    // 2) Initialize a one-shot latch to track task completion
-    std::latch done(tasks_.size());
+    WorkflowRun::Scope scope;
+    scope.tasks = plan.ancestors(wanted);
+    std::cout << "Workflow::run() - targets: " << std::count(scope.tasks.begin(), scope.tasks.end(), 1) << " of "
+              << plan.size() << " tasks needed\n";
+    return scope;
+}
 
-    std::cout << "Workflow::run() - latch created -  tasks_ size: " << tasks_.size() << "\n";
+void Workflow::resume(IThreadExecutor& executor) {
+    if (!journal_) throw std::logic_error("Workflow::resume() needs a checkpoint journal (setCheckpoint)");
+    const auto journaled = RunJournal::load(journal_->path());
+    finish(*launch(executor, &journaled));
+}
 
-    for (const auto& [id, rem] : remaining_) {
-        std::cout << "Task " << id << " remaining deps: " << rem.load() << "\n";
+ScenarioFanOut Workflow::runScenarios(IThreadExecutor& executor, const std::vector<AttributeSPtr>& scenarios) {
+    if (scenarios.empty()) throw std::invalid_argument("Workflow::runScenarios() - no scenario");
+    auto plan = compile();
+
+    // A task depends on the scenario when its fingerprint differs between two of them.
+    // Fingerprints include the upstream ones, so whatever is downstream of a
+    // dependent task is dependent too.
+    const auto reference = plan->fingerprints(scenarios.front(), context_);
+    std::vector<std::uint8_t> dependent(plan->size(), 0);
+    for (std::size_t k = 1; k < scenarios.size(); ++k) {
+        const auto fingerprints = plan->fingerprints(scenarios[k], context_);
+        for (ExecutionPlan::Index i = 0; i < plan->size(); ++i) dependent[i] |= fingerprints[i] != reference[i];
     }
 
-    
-    // 3) Define a helper to schedule a task and its downstream dependents
-    // tells the compiler exactly what the type of scheduleTask is, 
-    // so it can compile a recursive reference to itself.
-    std::function<void(const TaskID&)> scheduleTask = [&](const TaskID& id) {
-        executor.enqueue([&, id] {
-            tasks_.at(id)->run(attributes_, context_);
-    
-            for (const auto& child : children_[id]) {
-                if (remaining_[child].fetch_sub(1, std::memory_order_acq_rel) == 1) {
-                    std::cout << "Workflow::run() - scheduleTask: " << child << "\n";
-                    scheduleTask(child);
-                }
-            }
-    
-            std::cout << "Workflow::run() - count_down\n";
-            done.count_down();
-        });
-    };
-    
+    ScenarioFanOut fanOut;
+    WorkflowRun::Scope shared{.tasks = std::vector<std::uint8_t>(plan->size(), 0),
+                              .attributes = scenarios.front(),
+                              .reuseOthers = false,
+                              .upstream = nullptr};
+    for (ExecutionPlan::Index i = 0; i < plan->size(); ++i) {
+        shared.tasks[i] = !dependent[i];
+        if (dependent[i]) fanOut.dependentTasks.push_back(plan->idOf(i));
+    }
+    std::cout << "Workflow::runScenarios() - " << scenarios.size() << " scenarios, "
+              << plan->size() - fanOut.dependentTasks.size() << " shared tasks, "
+              << fanOut.dependentTasks.size() << " per scenario\n";
+
+    fanOut.shared = launch(executor, nullptr, &shared);
+    fanOut.shared->wait();
+
+    WorkflowRun::Scope perScenario{.tasks = std::move(dependent),
+                                   .attributes = nullptr,
+                                   .reuseOthers = true,
+                                   .upstream = fanOut.shared->artifacts()};
+    fanOut.scenarios.reserve(scenarios.size());
+    for (const auto& scenario : scenarios) {
+        perScenario.attributes = scenario;
+        fanOut.scenarios.push_back(launch(executor, nullptr, &perScenario));
+    }
+    for (auto& run : fanOut.scenarios) {
+        try {
+            run->wait();
+        } catch (...) {
+            // Kept in the run
+        }
+    }
+    return fanOut;
+}
 
-    // 4) Kick off tasks that have no dependencies
-    for (const auto& [id, _] : tasks_) {
-        if (remaining_[id].load(std::memory_order_acquire) == 0) {
-            std::cout << "Workflow::run() - scheduleTask no deps: " << id << "\n";
-            scheduleTask(id);  // schedule immediately
+WorkflowRunSPtr Workflow::launch(IThreadExecutor& executor, const WorkflowRun::Journaled* journaled,
+                                 const WorkflowRun::Scope* scope) {
+    // Compiled once, then reused: a repeat run only loads its own dependency counters
+    auto plan = compile();
+
+    const bool checkpointed = journal_ && !scope;
+    if (checkpointed) {
+        int idle = 0;
+        if (!activeRuns_.compare_exchange_strong(idle, 1, std::memory_order_acq_rel)) {
+            throw std::logic_error("Workflow::run() - a checkpointed workflow runs one run at a time");
         }
+    } else {
+        activeRuns_.fetch_add(1, std::memory_order_acq_rel);
     }
 
-    // 5) Wait for all tasks to finish
-    done.wait();
+    try {
+        if (checkpointed) {
+            if (journaled) journal_->reopen();
+            else journal_->start(name_);
+        }
+        auto run = std::make_shared<WorkflowRun>(WorkflowRun::Key{}, *this, executor, std::move(plan));
+        run->start(journaled, scope);
+        return run;
+    } catch (...) {
+        // Nothing was scheduled: the run will not complete
+        activeRuns_.fetch_sub(1, std::memory_order_acq_rel);
+        activeRuns_.notify_all();
+        throw;
+    }
+}
+
+void Workflow::finish(WorkflowRun& run) {
+    // A task that threw stops its dependents from being scheduled and its exception
+    // is rethrown here, once nothing is running any more
+    const auto publish = [&run] {
+        const ExecutionPlan& plan = *run.plan_;
+        for (ExecutionPlan::Index i = 0; i < plan.size(); ++i) plan.task(i).status = run.statusAt(i);
+    };
+    try {
+        run.wait();
+    } catch (...) {
+        publish();
+        throw;
+    }
+    publish();
 }
 
 } // namespace eden
@@ -5,8 +5,16 @@
 // #include "core/executor.h"
 #include "threadpool.h"
 #include "itask.h"
+#include "executionplan.h"
+#include "durationhistory.h"
+#include "resultcache.h"
+#include "runjournal.h"
+#include "workflowrun.h"
 #include <atomic>
-#include <latch>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,7 +22,6 @@
 
 
 // TODO: ranges, variants, span, coroutines, concepts
-// TODO: timeouts, retry, priorities
 // TODO: protobuf google 
 // Boost
 
@@ -32,6 +39,22 @@ class IWorkflow {
 
 // using LayoutMap = std::unordered_map<int, ImVec2>;
 
+/// What Workflow::run(executor, targets) must produce: tasks by id, and/or the
+/// producers of output ids
+struct RunTargets {
+    std::vector<TaskID> tasks;
+    std::vector<int> outputs;
+};
+
+/// Runs of Workflow::runScenarios
+struct ScenarioFanOut {
+    // The tasks whose inputs are the same in every scenario, run once
+    WorkflowRunSPtr shared;
+    // The rest (the dependent subgraph), one run per scenario, in the order given
+    std::vector<WorkflowRunSPtr> scenarios;
+    std::vector<TaskID> dependentTasks;
+};
+
 /**
  * @brief Workflow class
  * @details This class is used to store the workflow composed of tasks and its dependencies
@@ -50,8 +73,50 @@ private:
     // node links (In - Out)
     std::unordered_map<TaskID, std::vector<std::pair<int, int>>> links_;
 
-    std::unordered_map<TaskID, std::vector<TaskID>> children_;
-    std::unordered_map<TaskID, std::atomic<std::size_t>> remaining_;
+    // Compiled dependency graph, dropped whenever tasks or dependencies change.
+    // Shared with the runs using it, which keep it alive after a recompilation.
+    // planMutex_ guards the pointer, not the definition: tasks and dependencies must
+    // not change while a run is being launched.
+    std::shared_ptr<const ExecutionPlan> plan_;
+    std::mutex planMutex_;
+
+    // Per task type durations; when set, ready tasks run longest remaining path first
+    DurationHistorySPtr history_;
+
+    // Skip tasks whose fingerprint matches their last successful run
+    bool incremental_ = false;
+
+    // Results of cacheable tasks, shared between workflows and runs
+    ResultCacheSPtr cache_;
+
+    FailureMode failureMode_ = FailureMode::ContinueIndependent;
+
+    // Run linear chains of the plan back to back in one job
+    bool fusion_ = true;
+
+    // Checkpoint: completions of the current run, for resume()
+    std::unique_ptr<RunJournal> journal_;
+
+    // Written by runs as they complete
+    mutable std::mutex stateMutex_;
+    // Incremental runs: fingerprint of every task's inputs and upstream, as of its last
+    // successful run. Kept by id so that it survives a recompilation.
+    std::unordered_map<TaskID, Fingerprint> fingerprints_;
+    // Artifacts of the last incremental run, adopted by the next one for the tasks it reuses
+    std::shared_ptr<const ArtifactStore> lastArtifacts_;
+    MakespanReport report_;
+    // Runs not completed yet; the destructor waits for them
+    std::atomic<int> activeRuns_{0};
+
+    friend class WorkflowRun;
+
+    // Start a run of every task, or with journaled (resume) only those not completed yet
+    WorkflowRunSPtr launch(IThreadExecutor& executor, const WorkflowRun::Journaled* journaled,
+                           const WorkflowRun::Scope* scope = nullptr);
+    // The targets and their ancestors, by plan index
+    WorkflowRun::Scope scopeOf(const ExecutionPlan& plan, const RunTargets& targets) const;
+    // Wait for a run, then copy its statuses into the tasks
+    void finish(WorkflowRun& run);
 
 public:
   Workflow() = delete;
@@ -59,16 +124,100 @@ public:
   Workflow(Workflow&&) = delete;
   Workflow& operator=(const Workflow&) = delete;
   Workflow& operator=(Workflow&&) = delete;
-  ~Workflow() = default;
+  ~Workflow();
 
   // Constructor only valid with fullfillment of all parameters
   explicit Workflow(const std::string& name, const AttributeSPtr& attrs, const ContextSPtr& ctx)
     : name_(name), attributes_(std::move(attrs)), context_(std::move(ctx))
   {}
 
-  // Run with any executor; each task sees the same attrs_ and ctx_.
+  // Run with any executor and wait for the end; each task sees the same attrs_ and ctx_.
+  // Compiles the workflow first if needed. Task statuses are updated once it is over.
   void run(IThreadExecutor& executor);
 
+  // Start a run and return its handle without waiting. Several runs of the same
+  // workflow may be in flight at once (each with its own statuses and counters),
+  // except with a checkpoint, which belongs to one run: std::logic_error then.
+  [[nodiscard]] WorkflowRunSPtr runAsync(IThreadExecutor& executor);
+
+  // Run only what the targets need: the target tasks (or the producers of the target
+  // outputs) and everything upstream of them. The other tasks are Skipped. Incremental
+  // mode and the result cache apply as usual; not checkpointed. Throws
+  // std::out_of_range for an unknown task, std::invalid_argument for an output no
+  // task produces or without targets.
+  void run(IThreadExecutor& executor, const RunTargets& targets);
+  [[nodiscard]] WorkflowRunSPtr runAsync(IThreadExecutor& executor, const RunTargets& targets);
+
+  // Run the workflow once per scenario (or COB) without repeating what they share:
+  // the tasks whose fingerprint, upstream included, is the same for every scenario
+  // run once, then the tasks that depend on the scenario run once per scenario, all
+  // scenarios at the same time. Blocks until every run is over. An error in the
+  // shared part is rethrown; a scenario's error stays in its run (completion()).
+  // Task statuses are in the runs, ITask::status is left as is. Not checkpointed,
+  // not incremental. Throws std::invalid_argument without scenarios.
+  ScenarioFanOut runScenarios(IThreadExecutor& executor, const std::vector<AttributeSPtr>& scenarios);
+
+  // Journal every task completion to path (empty path: off). run() starts a new journal.
+  void setCheckpoint(const std::filesystem::path& path) {
+    journal_ = path.empty() ? nullptr : std::make_unique<RunJournal>(path);
+  }
+  // Continue the journaled run: tasks recorded as completed with the same inputs are
+  // marked Completed and skipped, the rest runs. A skipped task whose output a task
+  // that runs below it reads is restored from the result cache, or runs again.
+  // Throws std::logic_error without a checkpoint.
+  void resume(IThreadExecutor& executor);
+
+  // Build (or return the cached) execution plan. Throws std::runtime_error
+  // on an unknown task or a dependency cycle. The plan stays valid after the
+  // workflow changes, the next compile() builds a new one.
+  std::shared_ptr<const ExecutionPlan> compile();
+
+  // Record task durations into history and schedule by critical path (nullptr: off).
+  // The same history can be shared by several workflows.
+  void setDurationHistory(DurationHistorySPtr history) { history_ = std::move(history); }
+  [[nodiscard]] const DurationHistorySPtr& durationHistory() const noexcept { return history_; }
+  // Of the run completed last
+  [[nodiscard]] MakespanReport lastReport() const {
+    std::lock_guard lock(stateMutex_);
+    return report_;
+  }
+
+  // Incremental mode: run() only executes the tasks whose fingerprint changed since
+  // their last successful run, and everything downstream of them. The other tasks
+  // keep their previous results, artifacts included: an incremental run keeps every
+  // artifact it has, for the next one.
+  void setIncremental(bool incremental) noexcept { incremental_ = incremental; }
+  [[nodiscard]] bool incremental() const noexcept { return incremental_; }
+  // Force a task (and its dependents) to run next time, e.g. when an external input
+  // its fingerprint cannot see has changed
+  void invalidate(TaskID id) {
+    std::lock_guard lock(stateMutex_);
+    fingerprints_.erase(id);
+  }
+  void invalidateAll() {
+    std::lock_guard lock(stateMutex_);
+    fingerprints_.clear();
+    lastArtifacts_.reset();
+  }
+
+  void setFailureMode(FailureMode mode) noexcept { failureMode_ = mode; }
+  [[nodiscard]] FailureMode failureMode() const noexcept { return failureMode_; }
+
+  // Task fusion (on by default): a task whose single child has no other parent runs
+  // that child itself once it completes, in the same job on the same worker, instead
+  // of going back through the executor. Statuses, retries and timeouts stay per task.
+  void setFusion(bool fusion) noexcept { fusion_ = fusion; }
+  [[nodiscard]] bool fusion() const noexcept { return fusion_; }
+
+  // Look results up by input fingerprint before running a task, store them after.
+  // Only tasks implementing saveResult()/restoreResult() take part (nullptr: off).
+  void setResultCache(ResultCacheSPtr cache) { cache_ = std::move(cache); }
+  [[nodiscard]] const ResultCacheSPtr& resultCache() const noexcept { return cache_; }
+
+  // New inputs for the next run; runs already started keep theirs
+  void setAttributes(AttributeSPtr attrs) { attributes_ = std::move(attrs); }
+  void setContext(ContextSPtr ctx) { context_ = std::move(ctx); }
+
   void exportGraphviz(std::ostream& os) const;
 
   [[nodiscard]] ITask::Status statusOf(const TaskID& id) const { return tasks_.at(id)->status; }
@@ -81,11 +230,15 @@ public:
   
   Workflow& addTask(TaskID id, TaskSPtr task) {
     tasks_.emplace(id, task);
+    std::lock_guard lock(planMutex_);
+    plan_.reset();
     return *this;
   }
 
   Workflow& dependsOn(const TaskID& after, const TaskID& before) {
     deps_[after].push_back(before);
+    std::lock_guard lock(planMutex_);
+    plan_.reset();
     return *this;
   }
 
@@ -0,0 +1,658 @@
+#include "workflowrun.h"
+#include "workflow.h"
+#include "coroutinetask.h"
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <thread>
+#include <typeinfo>
+
+namespace eden {
+
+namespace {
+
+using Nanos = std::chrono::nanoseconds;
+
+// Cost of a task type never measured: the mean of the known ones, else this
+constexpr Nanos kUnknownDuration = std::chrono::milliseconds(1);
+
+constexpr int kYieldIterations = 16;
+
+double toMs(Nanos d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+} // namespace
+
+WorkflowRun::WorkflowRun(Key, Workflow& workflow, IThreadExecutor& executor, std::shared_ptr<const ExecutionPlan> plan)
+    : workflow_(workflow),
+      executor_(executor),
+      plan_(std::move(plan)),
+      counters_(*plan_),
+      attributes_(workflow.attributes_),
+      context_(workflow.context_),
+      incremental_(workflow.incremental_),
+      failureMode_(workflow.failureMode_),
+      fusion_(workflow.fusion_),
+      history_(workflow.history_),
+      cache_(workflow.cache_),
+      journal_(workflow.journal_.get()),
+      status_(std::make_unique<std::atomic<ITask::Status>[]>(plan_->size())),
+      attempts_(plan_->size(), 0),
+      firstAttempt_(plan_->size()),
+      completion_(promise_.get_future().share()) {}
+
+RunProgress WorkflowRun::progress() const noexcept {
+    RunProgress progress;
+    progress.total = plan_->size();
+    for (Index i = 0; i < plan_->size(); ++i) {
+        switch (statusAt(i)) {
+            case ITask::Status::Pending: ++progress.pending; break;
+            case ITask::Status::Running: ++progress.running; break;
+            case ITask::Status::Completed: ++progress.completed; break;
+            case ITask::Status::Failed: ++progress.failed; break;
+            case ITask::Status::Skipped: ++progress.skipped; break;
+        }
+    }
+    return progress;
+}
+
+ITask::Status WorkflowRun::status(TaskID id) const {
+    return statusAt(plan_->indexOf(id));
+}
+
+void WorkflowRun::cancel() noexcept {
+    cancelled_.store(true, std::memory_order_relaxed);
+    abort_.request_stop();
+    cancelRetries();
+}
+
+void WorkflowRun::wait() {
+    int idle = 0;
+    while (!done()) {
+        // Run whatever is queued, ours or not: our jobs may sit behind it
+        if (executor_.tryRunPendingJob()) {
+            idle = 0;
+            continue;
+        }
+        if (idle < kYieldIterations) {
+            ++idle;
+            std::this_thread::yield();
+            continue;
+        }
+        // Woken by any job of the run finishing, and by complete(). Registered before
+        // reading the state (both seq_cst, as in finishJob): either the state read is
+        // already past that job, or the job sees the waiter and notifies.
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        const std::uint64_t state = state_.load(std::memory_order_seq_cst);
+        if (!done()) state_.wait(state, std::memory_order_acquire);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+    completion_.get();
+}
+
+void WorkflowRun::predict() {
+    const ExecutionPlan& plan = *plan_;
+    const auto runs = [&](Index i) { return selected_.empty() || selected_[i]; };
+
+    std::vector<Nanos> cost(plan.size(), Nanos{-1});
+    Nanos known{0};
+    std::size_t count = 0;
+    for (Index i = 0; i < plan.size(); ++i) {
+        if (!runs(i)) {
+            cost[i] = Nanos{0};
+            continue;
+        }
+        if (auto estimate = history_->estimate(DurationHistory::typeOf(plan.task(i)))) {
+            cost[i] = *estimate;
+            known += *estimate;
+            ++count;
+        }
+    }
+    const Nanos fallback = count > 0 ? known / static_cast<Nanos::rep>(count) : kUnknownDuration;
+    for (auto& c : cost) {
+        if (c < Nanos{0}) c = fallback;
+    }
+
+    level_ = plan.bottomLevels(cost);
+
+    MakespanReport report;
+    report.workers = std::max<std::size_t>(1, executor_.concurrency());
+    for (const auto& c : cost) report.totalWork += c;
+
+    // Walk the critical path: the root with the highest level, then the child with the highest level
+    const auto higher = [&](Index a, Index b) { return level_[a] < level_[b]; };
+    auto roots = plan.roots();
+    if (!roots.empty()) {
+        auto at = *std::max_element(roots.begin(), roots.end(), higher);
+        report.criticalPath = level_[at];
+        while (true) {
+            if (runs(at)) report.criticalTasks.push_back(plan.idOf(at));
+            auto children = plan.children(at);
+            if (children.empty()) break;
+            at = *std::max_element(children.begin(), children.end(), higher);
+        }
+    }
+    report.predicted = std::max(report.criticalPath, report.totalWork / static_cast<Nanos::rep>(report.workers));
+    report_ = std::move(report);
+}
+
+void WorkflowRun::start(const Journaled* journaled, const Scope* scope) {
+    const ExecutionPlan& plan = *plan_;
+    std::cout << ">>> Workflow::run() started\n";
+
+    if (scope) {
+        journal_ = nullptr;
+        if (scope->attributes) {
+            // The workflow's fingerprints describe its own attributes
+            attributes_ = scope->attributes;
+            incremental_ = false;
+        }
+    }
+
+    // 1) Part of the graph may be skipped, the counters are then reset for the rest only:
+    // - scope: only the tasks in it can run
+    // - incremental: a task runs when its fingerprint changed since its last success
+    // - resume: a task runs unless the journal has it completed with the same inputs.
+    //   A journaled producer whose output is read by a task that runs below it must
+    //   republish it: from its cached result when it can be restored, otherwise it runs
+    //   again too (this process does not have its artifacts in memory)
+    // Whatever is downstream of a task that runs runs too, within the scope.
+    if (incremental_ || cache_ || journal_) current_ = plan.fingerprints(attributes_, context_);
+
+    // A task left out because it is done puts back the artifact its dependents read:
+    // restored from the cache (resume), or adopted from the last incremental run. Those
+    // of the tasks outside the scope are adopted too, for the runs after this one.
+    artifacts_ = std::make_shared<ArtifactStore>(scope ? scope->upstream : nullptr);
+    std::shared_ptr<const ArtifactStore> previous;
+    if (incremental_) {
+        std::lock_guard lock(workflow_.stateMutex_);
+        previous = workflow_.lastArtifacts_;
+    }
+
+    const auto isDone = [&](Index i) {
+        if (journaled) {
+            auto it = journaled->find(plan.idOf(i));
+            return it != journaled->end() && it->second.fingerprint == current_[i];
+        }
+        {
+            std::lock_guard lock(workflow_.stateMutex_);
+            auto it = workflow_.fingerprints_.find(plan.idOf(i));
+            if (it == workflow_.fingerprints_.end() || it->second != current_[i]) return false;
+        }
+        if (previous) artifacts_->adopt(*previous, plan.task(i).outputID());
+        return true;
+    };
+    const auto outside = [&](Index i) {
+        if (!scope || scope->tasks[i]) return false;
+        setStatus(i, scope->reuseOthers ? ITask::Status::Completed : ITask::Status::Skipped);
+        if (previous) artifacts_->adopt(*previous, plan.task(i).outputID());
+        return true;
+    };
+
+    // Journaled producers that have to run again, or whose result was restored
+    std::vector<std::uint8_t> rerun(plan.size(), 0);
+    std::vector<std::uint8_t> restored(plan.size(), 0);
+    std::size_t count = 0;
+    const auto select = [&] {
+        selected_.assign(plan.size(), 0);
+        count = 0;
+        for (Index i = 0; i < plan.size(); ++i) {
+            if (outside(i)) {
+                selected_[i] = 0;
+                continue;
+            }
+            if (!selected_[i] && !rerun[i] && isDone(i)) {
+                setStatus(i, ITask::Status::Completed);
+                continue;
+            }
+            selected_[i] = 1;
+            setStatus(i, ITask::Status::Pending);
+            ++count;
+            for (Index c : plan.children(i)) selected_[c] = 1;
+        }
+    };
+    // True when a task of this run below producer p reads its output
+    const auto readBelow = [&](Index p) {
+        const int output = plan.task(p).outputID();
+        std::vector<std::uint8_t> seen(plan.size(), 0);
+        std::vector<Index> stack(plan.children(p).begin(), plan.children(p).end());
+        while (!stack.empty()) {
+            Index c = stack.back();
+            stack.pop_back();
+            if (seen[c]) continue;
+            seen[c] = 1;
+            if (selected_[c] && plan.task(c).inputID() == output) return true;
+            for (Index g : plan.children(c)) stack.push_back(g);
+        }
+        return false;
+    };
+    const auto restore = [&](Index i) {
+        const auto& entry = journaled->at(plan.idOf(i));
+        auto bytes = cache_ && entry.result ? cache_->get(*entry.result) : std::nullopt;
+        return bytes && plan.task(i).restoreWithArtifacts(*bytes, *artifacts_);
+    };
+
+    if (incremental_ || journaled) {
+        select();
+        // Rerunning a producer makes its descendants run too, which may need more of them
+        for (bool changed = journaled != nullptr; changed;) {
+            changed = false;
+            for (Index i = 0; i < plan.size(); ++i) {
+                if (selected_[i] || restored[i] || !readBelow(i)) continue;
+                if (restore(i)) {
+                    restored[i] = 1;
+                } else {
+                    rerun[i] = 1;
+                    changed = true;
+                }
+            }
+            if (changed) select();
+        }
+        roots_ = counters_.reset(selected_);
+        std::cout << "Workflow::run() - " << (journaled ? "resume: " : "incremental: ") << count << " of "
+                  << plan.size() << " tasks to run\n";
+    } else if (scope) {
+        selected_ = scope->tasks;
+        for (Index i = 0; i < plan.size(); ++i) {
+            if (!outside(i)) setStatus(i, ITask::Status::Pending);
+        }
+        roots_ = counters_.reset(selected_);
+    } else {
+        counters_.reset();
+        roots_.assign(plan.roots().begin(), plan.roots().end());
+        for (Index i = 0; i < plan.size(); ++i) setStatus(i, ITask::Status::Pending);
+    }
+    if (incremental_) succeeded_.assign(plan.size(), 0);
+
+    // Every task of the run reading an artifact is one of its consumers; one read by a
+    // task left out of the run is kept for it. An incremental run keeps them all: the
+    // next one adopts those of the tasks it reuses.
+    std::unordered_map<int, std::uint32_t> consumers;
+    for (Index i = 0; i < plan.size(); ++i) {
+        const int input = plan.task(i).inputID();
+        if (incremental_) artifacts_->pin(plan.task(i).outputID());
+        if (selected_.empty() || selected_[i]) ++consumers[input];
+        else artifacts_->pin(input);
+    }
+    for (const auto& [id, count] : consumers) artifacts_->expect(id, count);
+
+    // 3) With a duration history, every task is ranked by its bottom level (the longest
+    // predicted path from it to the end). Ready tasks wait in a heap and each job takes
+    // the best one when it starts, so the order does not depend on the executor's queues.
+    ordered_ = history_ != nullptr;
+    if (ordered_) predict();
+
+    std::cout << "Workflow::run() - run started -  tasks_ size: " << plan.size() << "\n";
+
+    // 4) Kick off tasks that have no dependencies. The run holds one job of its own
+    // meanwhile, so that it cannot complete before every root is scheduled (and does
+    // complete when there is nothing to run).
+    started_ = Clock::now();
+    state_.fetch_add(kEpoch + 1, std::memory_order_relaxed);
+    try {
+        schedule(roots_);
+    } catch (...) {
+        fail(std::current_exception());
+    }
+    finishJob();
+}
+
+void WorkflowRun::fail(std::exception_ptr error) noexcept {
+    if (!failed_.exchange(true, std::memory_order_relaxed)) error_ = std::move(error);
+}
+
+void WorkflowRun::finishJob() noexcept {
+    const std::uint64_t previous = state_.fetch_add(kEpoch - 1, std::memory_order_seq_cst);
+    if ((previous & kPendingMask) == 1) {
+        complete();
+        return;
+    }
+    // Nobody parked in wait(): no futex wake-up per job
+    if (waiters_.load(std::memory_order_seq_cst) > 0) state_.notify_all();
+}
+
+void WorkflowRun::complete() noexcept {
+    const ExecutionPlan& plan = *plan_;
+
+    // Tasks a failed task's error stopped from being scheduled, or the run was aborted:
+    // still Pending, they never ran
+    std::size_t failed = 0;
+    std::size_t skipped = 0;
+    for (Index i = 0; i < plan.size(); ++i) {
+        if (!selected_.empty() && !selected_[i]) continue;
+        if (statusAt(i) == ITask::Status::Pending) setStatus(i, ITask::Status::Skipped);
+        failed += statusAt(i) == ITask::Status::Failed;
+        skipped += statusAt(i) == ITask::Status::Skipped;
+    }
+    if (failed > 0 || skipped > 0) {
+        std::cout << "Workflow::run() - " << failed << " failed, " << skipped << " skipped\n";
+    }
+    if (cache_) {
+        const auto stats = cache_->stats();
+        std::cout << "Workflow::run() - result cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.entries << " entries (" << stats.bytes << " bytes)\n";
+    }
+    if (ordered_) {
+        report_.actual = Clock::now() - started_;
+        std::cout << "Workflow::run() - makespan predicted " << toMs(report_.predicted) << " ms, actual "
+                  << toMs(report_.actual) << " ms (critical path " << toMs(report_.criticalPath)
+                  << " ms over " << report_.criticalTasks.size() << " tasks, total work "
+                  << toMs(report_.totalWork) << " ms on " << report_.workers << " workers)\n";
+    }
+
+    // Tasks that completed are remembered either way; the others will run again next time
+    {
+        std::lock_guard lock(workflow_.stateMutex_);
+        if (ordered_) workflow_.report_ = report_;
+        if (incremental_) {
+            workflow_.lastArtifacts_ = artifacts_;
+            for (Index i = 0; i < plan.size(); ++i) {
+                if (succeeded_[i]) workflow_.fingerprints_[plan.idOf(i)] = current_[i];
+                else if (selected_[i]) workflow_.fingerprints_.erase(plan.idOf(i));
+            }
+        }
+    }
+    // Last use of the workflow, which may be destroyed from here on
+    workflow_.activeRuns_.fetch_sub(1, std::memory_order_acq_rel);
+    workflow_.activeRuns_.notify_all();
+
+    // done() before the future is ready: whoever sees the future ready sees done()
+    finished_.store(true, std::memory_order_release);
+    if (failed_.load(std::memory_order_acquire)) {
+        promise_.set_exception(error_);
+    } else if (cancelled()) {
+        promise_.set_exception(std::make_exception_ptr(RunCancelledError("Workflow run cancelled")));
+    } else {
+        promise_.set_value();
+    }
+    state_.fetch_add(kEpoch, std::memory_order_release);
+    state_.notify_all();
+}
+
+// Explicit priorities first, then the longest remaining path, then the plan order
+bool WorkflowRun::runsAfter(Index a, Index b) const noexcept {
+    const auto pa = plan_->task(a).priority();
+    const auto pb = plan_->task(b).priority();
+    if (pa != pb) return pa < pb;
+    if (level_[a] != level_[b]) return level_[a] < level_[b];
+    return a > b;
+}
+
+WorkflowRun::Index WorkflowRun::popReady() {
+    const auto before = [this](Index a, Index b) { return runsAfter(a, b); };
+    std::lock_guard lock(readyMutex_);
+    std::pop_heap(readyHeap_.begin(), readyHeap_.end(), before);
+    const Index index = readyHeap_.back();
+    readyHeap_.pop_back();
+    return index;
+}
+
+Job WorkflowRun::jobFor(Index index) {
+    if (ordered_) return wrap([this] { runTask(popReady()); });
+    return wrap([this, index] { runTask(index); });
+}
+
+// The task's priority hint lets a priority-aware executor run it ahead of others.
+// Several ready tasks go through enqueueBulk, one batch per priority level,
+// so a large fan-out costs one publish and one wake-up instead of one per child.
+void WorkflowRun::schedule(std::span<const Index> ready) {
+    if (ready.empty()) return;
+    const ExecutionPlan& plan = *plan_;
+    if (ordered_) {
+        const auto before = [this](Index a, Index b) { return runsAfter(a, b); };
+        // Published before the jobs: each job finds at least one task in the heap
+        std::lock_guard lock(readyMutex_);
+        for (Index index : ready) {
+            readyHeap_.push_back(index);
+            std::push_heap(readyHeap_.begin(), readyHeap_.end(), before);
+        }
+    }
+    if (ready.size() == 1) {
+        executor_.enqueue(jobFor(ready.front()), plan.task(ready.front()).priority());
+        return;
+    }
+
+    std::vector<Job> batch;
+    batch.reserve(ready.size());
+    for (std::size_t lane = 0; lane < kJobPriorityCount; ++lane) {
+        const auto priority = static_cast<JobPriority>(lane);
+        batch.clear();
+        for (Index index : ready) {
+            if (plan.task(index).priority() == priority) batch.push_back(jobFor(index));
+        }
+        if (!batch.empty()) executor_.enqueueBulk(batch, priority);
+    }
+}
+
+// Children released by a finished task are scheduled together, except the next task
+// of a fused chain: returned, for the caller's job to run it
+WorkflowRun::Index WorkflowRun::releaseChildren(Index index) {
+    const Index next = plan_->fusedChild(index);
+    if (fusion_ && next != ExecutionPlan::kNoTask && (selected_.empty() || selected_[next]) &&
+        plan_->task(next).priority() == plan_->task(index).priority() && counters_.release(next)) {
+        return next;
+    }
+
+    std::vector<Index> ready;
+    for (Index child : plan_->children(index)) {
+        if (!selected_.empty() && !selected_[child]) continue;
+        if (counters_.release(child)) ready.push_back(child);
+    }
+    schedule(ready);
+    return ExecutionPlan::kNoTask;
+}
+
+// Cache key: the task's full input fingerprint and its concrete type
+Fingerprint WorkflowRun::cacheKey(Index index) const {
+    return Hasher(current_[index]).add(std::string_view(typeid(plan_->task(index)).name())).value();
+}
+
+WorkflowRun::Index WorkflowRun::completed(Index index, std::optional<Clock::time_point> started) {
+    ITask& task = plan_->task(index);
+    if (history_ && started) history_->record(DurationHistory::typeOf(task), Clock::now() - *started);
+
+    // The journal entry refers to the cached result, if there is one
+    std::optional<Fingerprint> result;
+    if (cache_) {
+        if (!started) {
+            result = cacheKey(index);
+        } else if (auto bytes = task.saveResult()) {
+            result = cacheKey(index);
+            cache_->put(*result, *bytes);
+        }
+    }
+    setStatus(index, ITask::Status::Completed);
+    artifacts_->consumed(task.inputID());
+    if (journal_) journal_->completed({plan_->idOf(index), current_[index], result});
+    if (incremental_) succeeded_[index] = 1;
+    return releaseChildren(index);
+}
+
+// A failed attempt is rescheduled after its backoff if the policy allows it,
+// otherwise the task is Failed and the error goes to the run: its dependents are
+// never released (and, in AbortRun mode, the whole run stops)
+void WorkflowRun::retryOrThrow(Index index, std::exception_ptr error) {
+    ITask& task = plan_->task(index);
+    if (abort_.stop_requested()) {
+        // Cancelled, or stopped by another task's failure
+        setStatus(index, ITask::Status::Skipped);
+        return;
+    }
+
+    const TaskPolicy& policy = task.policy();
+    const unsigned failed = attempts_[index];
+    const auto delay = policy.backoffAfter(failed);
+    bool retry = failed < policy.maxAttempts;
+    if (retry && policy.deadline.count() > 0) retry = Clock::now() + delay < firstAttempt_[index] + policy.deadline;
+    const auto giveUp = [&] {
+        setStatus(index, ITask::Status::Failed);
+        if (failureMode_ == FailureMode::AbortRun) {
+            abort_.request_stop();
+            cancelRetries();
+        }
+        std::rethrow_exception(error);
+    };
+    if (!retry) giveUp();
+    setStatus(index, ITask::Status::Pending);
+
+    const bool delayed = delay.count() > 0 && executor_.hasTimers();
+    std::string when = "now";
+    if (delayed) {
+        when = std::format("in {} ms", delay.count());
+    } else if (delay.count() > 0) {
+        when = std::format("now, the executor has no timers for the {} ms backoff", delay.count());
+    }
+    std::cout << "Workflow::run() - task " << plan_->idOf(index) << " failed (attempt " << failed << " of "
+              << policy.maxAttempts << "), retrying " << when << "\n";
+    if (delayed) {
+        {
+            // Checked under the lock: cancelRetries() either sees this timer or it is not armed
+            std::lock_guard lock(retryMutex_);
+            if (abort_.stop_requested()) {
+                setStatus(index, ITask::Status::Skipped);
+                return;
+            }
+            const TimerId timer = executor_.enqueueAfter(delay, wrap([this, index] {
+                {
+                    std::lock_guard lock(retryMutex_);
+                    retries_.erase(index);
+                }
+                runTask(index);
+            }));
+            if (timer != 0) {
+                retries_[index] = timer;
+                return;
+            }
+        }
+        // The executor is being destroyed and dropped the retry without running it:
+        // release its job here, and the failure of this attempt stands
+        finishJob();
+        giveUp();
+    } else {
+        executor_.enqueue(wrap([this, index] { runTask(index); }), task.priority());
+    }
+}
+
+// A cancelled timer never runs its job, so the job it held is released here. Those
+// that fired already run, see the abort and skip their task.
+void WorkflowRun::cancelRetries() noexcept {
+    std::unordered_map<Index, TimerId> armed;
+    {
+        std::lock_guard lock(retryMutex_);
+        armed.swap(retries_);
+    }
+    for (const auto& [index, timer] : armed) {
+        if (!executor_.cancelTimer(timer)) continue;
+        setStatus(index, ITask::Status::Skipped);
+        finishJob();
+    }
+}
+
+void WorkflowRun::runTask(Index index) {
+    // A fused chain runs back to back in this job, one task at a time
+    while (index != ExecutionPlan::kNoTask) index = runOne(index);
+}
+
+WorkflowRun::Index WorkflowRun::runOne(Index index) {
+    // Aborted or cancelled: the task stays Pending and ends up Skipped
+    if (abort_.stop_requested()) return ExecutionPlan::kNoTask;
+
+    ITask& task = plan_->task(index);
+    const auto started = Clock::now();
+
+    if (++attempts_[index] == 1) {
+        firstAttempt_[index] = started;
+        // A cached result with the same inputs replaces the run
+        if (cache_) {
+            if (auto bytes = cache_->get(cacheKey(index)); bytes && task.restoreWithArtifacts(*bytes, *artifacts_)) {
+                return completed(index, std::nullopt);
+            }
+        }
+    }
+
+    setStatus(index, ITask::Status::Running);
+
+    if (auto* coroutine = dynamic_cast<CoroutineTask*>(&task)) {
+        runCoroutine(index, *coroutine, started);
+        return ExecutionPlan::kNoTask;
+    }
+
+    // The timeout requests stop through a timer; the attempt then fails once the
+    // task returns (an executor without timers only gets the check at the end).
+    // Aborting or cancelling the run requests it too.
+    const auto timeout = task.policy().timeout;
+    std::stop_source stop;
+    std::stop_callback onAbort(abort_.get_token(), [&stop] { stop.request_stop(); });
+    TimerId timer = 0;
+    if (timeout.count() > 0 && executor_.hasTimers()) {
+        timer = executor_.enqueueAfter(timeout, [stop]() mutable { stop.request_stop(); });
+    }
+    try {
+        task.runWithArtifacts(attributes_, context_, stop.get_token(), *artifacts_);
+        if (timer != 0) executor_.cancelTimer(timer);
+        if (abort_.stop_requested()) {
+            setStatus(index, ITask::Status::Skipped);
+            return ExecutionPlan::kNoTask;
+        }
+        if (timeout.count() > 0 && (stop.stop_requested() || Clock::now() - started > timeout)) {
+            throw TaskTimeoutError(std::format("Task {} timed out after {} ms", plan_->idOf(index), timeout.count()));
+        }
+    } catch (...) {
+        if (timer != 0) executor_.cancelTimer(timer);
+        retryOrThrow(index, std::current_exception());
+        return ExecutionPlan::kNoTask;
+    }
+    return completed(index, started);
+}
+
+// A coroutine task only holds the worker until its first suspension; the run counts
+// it until it completes, on whichever thread resumes it last. The timeout, aborting
+// and cancelling work as in runOne, and the attempt is judged by the job that
+// finishes it. It does not take part in the artifact dataflow.
+void WorkflowRun::runCoroutine(Index index, CoroutineTask& task, Clock::time_point started) {
+    struct RequestStop {
+        std::stop_source stop;
+        void operator()() noexcept { stop.request_stop(); }
+    };
+    struct Attempt {
+        std::stop_source stop;
+        TimerId timer = 0;
+        std::exception_ptr error;
+        // Linked to the run's abort_ until the coroutine has finished
+        std::optional<std::stop_callback<RequestStop>> onAbort;
+    };
+    auto attempt = std::make_shared<Attempt>();
+    attempt->onAbort.emplace(abort_.get_token(), RequestStop{attempt->stop});
+    const auto timeout = task.policy().timeout;
+
+    Job finish = wrap([this, index, attempt, started, timeout] {
+        attempt->onAbort.reset();
+        if (attempt->timer != 0) executor_.cancelTimer(attempt->timer);
+        if (abort_.stop_requested()) {
+            // Stopped by another task's failure or by cancel(), whatever it returned
+            setStatus(index, ITask::Status::Skipped);
+            return;
+        }
+        std::exception_ptr error = attempt->error;
+        if (!error && timeout.count() > 0 &&
+            (attempt->stop.stop_requested() || Clock::now() - started > timeout)) {
+            error = std::make_exception_ptr(
+                TaskTimeoutError(std::format("Task {} timed out after {} ms", plan_->idOf(index), timeout.count())));
+        }
+        if (error) {
+            retryOrThrow(index, error);
+            return;
+        }
+        runTask(completed(index, started));
+    });
+    if (timeout.count() > 0 && executor_.hasTimers()) {
+        attempt->timer = executor_.enqueueAfter(timeout, [stop = attempt->stop]() mutable { stop.request_stop(); });
+    }
+    start_detached(task.runAsyncCancellable(attributes_, context_, attempt->stop.get_token()),
+        [attempt, finish = std::move(finish)](std::exception_ptr e) mutable {
+            attempt->error = e;
+            finish();
+        });
+}
+
+} // namespace eden
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "executionplan.h"
+#include "durationhistory.h"
+#include "resultcache.h"
+#include "runjournal.h"
+#include "threadpool.h"
+#include "itask.h"
+#include "artifactstore.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+namespace eden {
+
+class Workflow;
+class CoroutineTask;
+
+/**
+ * @brief Predicted and measured duration of the last run
+ * @details Filled by Workflow::run when a DurationHistory is attached. The prediction
+ * is the usual lower bound for a DAG on `workers` threads: the run cannot be shorter
+ * than its critical path, nor than the total work shared evenly.
+ */
+struct MakespanReport {
+    std::chrono::nanoseconds predicted{0};
+    std::chrono::nanoseconds criticalPath{0};
+    std::chrono::nanoseconds totalWork{0};
+    std::chrono::nanoseconds actual{0};
+    std::size_t workers = 0;
+    // Longest predicted chain, from its root to its last task
+    std::vector<TaskID> criticalTasks;
+};
+
+/**
+ * @brief What Workflow::run does when a task fails for good (retries exhausted)
+ * @details Either way the failed task's descendants are marked Skipped without running,
+ * and run() rethrows the first error once nothing is running any more.
+ * - ContinueIndependent: tasks that do not depend on the failure carry on
+ * - AbortRun: nothing new starts, and the tasks still running get their stop token
+ *   requested; those that stop (return or throw) are marked Skipped
+ */
+enum class FailureMode { ContinueIndependent, AbortRun };
+
+/// Task counts of a run, by status
+struct RunProgress {
+    std::size_t total = 0;
+    std::size_t pending = 0;
+    std::size_t running = 0;
+    std::size_t completed = 0;
+    std::size_t failed = 0;
+    std::size_t skipped = 0;
+
+    [[nodiscard]] bool finished() const noexcept { return pending == 0 && running == 0; }
+};
+
+/// Completion error of a run stopped by WorkflowRun::cancel()
+class RunCancelledError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief One execution of a workflow, and the handle to it
+ * @details Everything that changes while tasks run lives here: dependency counters,
+ * task statuses, retry attempts, the ready heap. The Workflow only holds the definition
+ * (tasks, dependencies, compiled plan, settings), so the same workflow can have any
+ * number of runs in flight on one executor. Attributes, context and settings are
+ * captured when the run starts.
+ *
+ * Tasks are shared by the runs of a workflow: a task running in several runs at
+ * once must be reentrant. ITask::status is only updated by the blocking
+ * Workflow::run()/resume(), once the run is over; status() and progress() give the
+ * live view.
+ *
+ * Jobs hold a reference to the run, so the handle can be dropped at any time.
+ * The workflow must outlive its runs; its destructor waits for them.
+ */
+class WorkflowRun : public std::enable_shared_from_this<WorkflowRun> {
+public:
+    using Index = ExecutionPlan::Index;
+    using Journaled = std::unordered_map<TaskID, RunJournal::Entry>;
+
+    WorkflowRun(const WorkflowRun&) = delete;
+    WorkflowRun& operator=(const WorkflowRun&) = delete;
+    ~WorkflowRun() = default;
+
+    [[nodiscard]] RunProgress progress() const noexcept;
+    // Throws std::out_of_range for a task that is not part of the workflow
+    [[nodiscard]] ITask::Status status(TaskID id) const;
+
+    [[nodiscard]] bool done() const noexcept { return finished_.load(std::memory_order_acquire); }
+    // Ready once every task has finished or been skipped. get() rethrows the first
+    // task error, or RunCancelledError after cancel().
+    [[nodiscard]] std::shared_future<void> completion() const { return completion_; }
+    // Help run queued jobs until the run is over, then behave like completion().get()
+    void wait();
+
+    // Start nothing new and request stop on the tasks running (cooperative)
+    void cancel() noexcept;
+    [[nodiscard]] bool cancelled() const noexcept { return cancelled_.load(std::memory_order_relaxed); }
+
+    // Data published by the tasks; what is left once done() are the run's outputs
+    [[nodiscard]] std::shared_ptr<const ArtifactStore> artifacts() const noexcept { return artifacts_; }
+
+    // Valid once done(), with a duration history attached
+    [[nodiscard]] const MakespanReport& report() const noexcept { return report_; }
+
+private:
+    friend class Workflow;
+    using Clock = std::chrono::steady_clock;
+
+    // Token for the private constructor: only Workflow creates runs, through make_shared
+    struct Key {};
+
+    // Part of the graph a run is limited to (scenario fan-out, targets). Tasks outside
+    // it are Completed when their results are reused, Skipped otherwise. A scoped run
+    // has no checkpoint, and is not incremental when it has attributes of its own.
+    struct Scope {
+        std::vector<std::uint8_t> tasks;  // by plan index
+        AttributeSPtr attributes;         // nullptr: the workflow's
+        bool reuseOthers = false;
+        // Artifacts of the run that produced the reused results
+        std::shared_ptr<const ArtifactStore> upstream;
+    };
+
+public:
+    WorkflowRun(Key, Workflow& workflow, IThreadExecutor& executor, std::shared_ptr<const ExecutionPlan> plan);
+
+private:
+    // Select the tasks to run (journaled: resume; scope: part of the graph only),
+    // then schedule the roots
+    void start(const Journaled* journaled, const Scope* scope);
+
+    void predict();
+
+    // Job belonging to the run: counted until it has run
+    template <class F>
+    Job wrap(F&& f) {
+        state_.fetch_add(kEpoch + 1, std::memory_order_relaxed);
+        return [self = shared_from_this(), fn = std::forward<F>(f)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                self->fail(std::current_exception());
+            }
+            self->finishJob();
+        };
+    }
+    void fail(std::exception_ptr error) noexcept;
+    void finishJob() noexcept;
+    void complete() noexcept;
+
+    void schedule(std::span<const Index> ready);
+    Job jobFor(Index index);
+    // Heap order of the ready tasks: true when a runs after b
+    bool runsAfter(Index a, Index b) const noexcept;
+    Index popReady();
+    // These return the next task of a fused chain to run in the same job, if any
+    Index releaseChildren(Index index);
+    Index completed(Index index, std::optional<Clock::time_point> started);
+    Index runOne(Index index);
+    void runCoroutine(Index index, CoroutineTask& task, Clock::time_point started);
+    void runTask(Index index);
+    void retryOrThrow(Index index, std::exception_ptr error);
+    // Drop the retries waiting for their backoff, once abort_ is requested
+    void cancelRetries() noexcept;
+    Fingerprint cacheKey(Index index) const;
+
+    void setStatus(Index index, ITask::Status status) noexcept {
+        status_[index].store(status, std::memory_order_relaxed);
+    }
+    ITask::Status statusAt(Index index) const noexcept { return status_[index].load(std::memory_order_relaxed); }
+
+    Workflow& workflow_;
+    IThreadExecutor& executor_;
+    std::shared_ptr<const ExecutionPlan> plan_;
+    ExecutionPlan::Counters counters_;
+
+    // Captured at start
+    AttributeSPtr attributes_;
+    ContextSPtr context_;
+    bool incremental_ = false;
+    FailureMode failureMode_ = FailureMode::ContinueIndependent;
+    bool fusion_ = true;
+    DurationHistorySPtr history_;
+    ResultCacheSPtr cache_;
+    RunJournal* journal_ = nullptr;
+
+    // selected[i] == 0: task i is not part of this run (empty: all are)
+    std::vector<std::uint8_t> selected_;
+    std::vector<Index> roots_;
+    std::vector<Fingerprint> current_;
+    ArtifactStoreSPtr artifacts_;
+    std::unique_ptr<std::atomic<ITask::Status>[]> status_;
+    // Written by the task's own job only, read once the run is over
+    std::vector<std::uint8_t> succeeded_;
+    std::vector<unsigned> attempts_;
+    std::vector<Clock::time_point> firstAttempt_;
+
+    // Critical-path order (with a duration history)
+    bool ordered_ = false;
+    std::vector<std::chrono::nanoseconds> level_;
+    std::mutex readyMutex_;
+    std::vector<Index> readyHeap_;
+    MakespanReport report_;
+    Clock::time_point started_;
+
+    // Same scheme as TaskGroup: outstanding jobs (low half) and an epoch (high half)
+    static constexpr std::uint64_t kEpoch = std::uint64_t{1} << 32;
+    static constexpr std::uint64_t kPendingMask = kEpoch - 1;
+    std::atomic<std::uint64_t> state_{0};
+    // Threads parked in wait(), which finishJob() wakes
+    std::atomic<std::uint32_t> waiters_{0};
+    std::atomic<bool> failed_{false};
+    // Written once, by the job that sets failed_
+    std::exception_ptr error_;
+
+    std::stop_source abort_;
+    // Retries armed on the executor's timers, by task; each holds a job of the run
+    std::mutex retryMutex_;
+    std::unordered_map<Index, TimerId> retries_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> finished_{false};
+    std::promise<void> promise_;
+    std::shared_future<void> completion_;
+};
+
+using WorkflowRunSPtr = std::shared_ptr<WorkflowRun>;
+
+} // namespace eden
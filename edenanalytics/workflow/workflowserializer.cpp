@@ -3,6 +3,7 @@
 #include "task/fetchdatatask.h"
 #include <fstream>
 #include <stdexcept>
+#include <string>
 #include <iomanip>
 
 using namespace eden;
@@ -25,6 +26,7 @@ void WorkflowSerializer::save(const WorkflowUPtr& workflow, const std::string& j
         t["status"] = task->statusString(); // "Pending", etc.
         t["input_id"] = task->inputID();
         t["output_id"] = task->outputID();
+        t["priority"] = static_cast<int>(task->priority());
         data["tasks"].push_back(std::move(t));
     }
 
@@ -89,6 +91,16 @@ void WorkflowSerializer::load(WorkflowUPtr& workflow, const std::string& jsonFil
 
       task->setStatusFromString(status);
 
+      // Optional, older files have no priority
+      if (jsonTask.contains("priority")) {
+        // Indexes the executor's priority lanes
+        auto priority = jsonTask["priority"].get<int>();
+        if (priority < 0 || priority >= static_cast<int>(kJobPriorityCount)) {
+          throw std::runtime_error("Invalid task priority: " + std::to_string(priority));
+        }
+        task->setPriority(static_cast<JobPriority>(priority));
+      }
+
       workflow->addTask(taskID, task);
     }
 
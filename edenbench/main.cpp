@@ -0,0 +1,176 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace eden;
+
+/**
+ * ThreadPool micro-benchmarks.
+ *
+ * usage: edenbench [threads] [jobs]
+ *
+ * - external: the main thread enqueues every job (Workflow::run roots)
+ * - fanout:   jobs spawn their children from inside the workers (Workflow::run children)
+ * - latency:  enqueue-to-start p50/p99, for a chain of dependent jobs (hot pool)
+ *             and for jobs submitted to an idle pool (parked workers)
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A few hundred nanoseconds of work so that the benchmark is not pure queue overhead
+void spin(std::size_t iterations) {
+    volatile std::size_t sink = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink = sink + i;
+    }
+}
+
+const char* modeName(SchedulingMode mode) {
+    switch (mode) {
+        case SchedulingMode::SharedStack: return "SharedStack";
+        case SchedulingMode::WorkStealing: return "WorkStealing";
+        case SchedulingMode::Priority: return "Priority";
+    }
+    return "Unknown";
+}
+
+double benchExternal(ThreadPool& pool, std::size_t jobs) {
+    std::latch done(static_cast<std::ptrdiff_t>(jobs));
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < jobs; ++i) {
+        pool.enqueue([&done] {
+            spin(200);
+            done.count_down();
+        });
+    }
+    done.wait();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double benchFanout(ThreadPool& pool, std::size_t jobs) {
+    // Binary tree with at least `jobs` nodes
+    int depth = 0;
+    while ((std::size_t{2} << depth) - 1 < jobs) ++depth;
+    const std::size_t nodes = (std::size_t{2} << depth) - 1;
+
+    std::latch done(static_cast<std::ptrdiff_t>(nodes));
+    std::function<void(int)> spawn = [&](int level) {
+        pool.enqueue([&, level] {
+            spin(200);
+            if (level < depth) {
+                spawn(level + 1);
+                spawn(level + 1);
+            }
+            done.count_down();
+        });
+    };
+
+    const auto start = Clock::now();
+    spawn(0);
+    done.wait();
+    return std::chrono::duration<double>(Clock::now() - start).count() * jobs / nodes;
+}
+
+// A chain where each job enqueues the next one, like a task releasing its only child
+std::vector<double> latencyChain(ThreadPool& pool, std::size_t samples) {
+    std::vector<double> latencies(samples);
+    std::latch done(1);
+    std::function<void(std::size_t)> next = [&](std::size_t i) {
+        const auto enqueued = Clock::now();
+        pool.enqueue([&, i, enqueued] {
+            latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - enqueued).count();
+            if (i + 1 < samples) {
+                next(i + 1);
+            } else {
+                done.count_down();
+            }
+        });
+    };
+    next(0);
+    done.wait();
+    return latencies;
+}
+
+// One job at a time on a pool left idle in between, so workers have gone to sleep
+std::vector<double> latencyIdle(ThreadPool& pool, std::size_t samples) {
+    std::vector<double> latencies(samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::latch done(1);
+        const auto enqueued = Clock::now();
+        pool.enqueue([&, i, enqueued] {
+            latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - enqueued).count();
+            done.count_down();
+        });
+        done.wait();
+    }
+    return latencies;
+}
+
+void reportLatency(const std::string& scenario, SchedulingMode mode, std::vector<double> latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))];
+    };
+    std::cout << std::left << std::setw(10) << scenario
+              << std::setw(14) << modeName(mode)
+              << std::right << std::fixed << std::setprecision(1)
+              << "  p50 " << std::setw(8) << percentile(0.50) << " us"
+              << "  p99 " << std::setw(8) << percentile(0.99) << " us\n";
+}
+
+void report(const std::string& scenario, SchedulingMode mode, std::size_t jobs, double seconds) {
+    std::cout << std::left << std::setw(10) << scenario
+              << std::setw(14) << modeName(mode)
+              << std::right << std::setw(12) << std::fixed << std::setprecision(0)
+              << jobs / seconds << " jobs/s\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                         : HardwareConcurrencyProvider{}.getThreadCount();
+    const std::size_t jobs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    constexpr int repetitions = 3;
+
+    std::cout << "ThreadPool benchmark - threads: " << threads << " jobs: " << jobs << "\n";
+
+    for (auto mode : {SchedulingMode::SharedStack, SchedulingMode::WorkStealing, SchedulingMode::Priority}) {
+        ThreadPool pool(threads, mode);
+
+        double best = 1e30;
+        for (int r = 0; r < repetitions; ++r) best = std::min(best, benchExternal(pool, jobs));
+        report("external", mode, jobs, best);
+
+        best = 1e30;
+        for (int r = 0; r < repetitions; ++r) best = std::min(best, benchFanout(pool, jobs));
+        report("fanout", mode, jobs, best);
+
+        // Node allocations only happen while the pool grows to the peak queue depth
+        const auto nodes = pool.allocationCount();
+        benchExternal(pool, jobs);
+        benchFanout(pool, jobs);
+        std::cout << "          node allocations: " << nodes
+                  << " (+" << pool.allocationCount() - nodes << " on a further run)"
+                  << ", job heap allocations: " << Job::heapAllocations() << "\n";
+
+        reportLatency("chain", mode, latencyChain(pool, 20000));
+        reportLatency("idle", mode, latencyIdle(pool, 500));
+        std::cout << "          stats " << pool.stats();
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "artifactstore.h"
+#include <algorithm>
+#include <optional>
+
+namespace eden {
+
+void ArtifactStore::store(int id, std::shared_ptr<const void> value, std::type_index type) {
+    std::lock_guard lock(mutex_);
+    auto [it, inserted] = entries_.insert_or_assign(id, Entry{std::move(value), type});
+    ++stats_.published;
+    if (inserted) {
+        stats_.live = entries_.size();
+        stats_.peakLive = std::max(stats_.peakLive, stats_.live);
+    }
+}
+
+std::shared_ptr<const void> ArtifactStore::find(int id, std::type_index type) const {
+    {
+        std::lock_guard lock(mutex_);
+        if (const Entry* entry = lookup(id)) {
+            if (entry->type != type) {
+                throw std::invalid_argument("ArtifactStore::get() - artifact " + std::to_string(id) + " is a " +
+                                            entry->type.name() + ", not a " + type.name());
+            }
+            return entry->value;
+        }
+    }
+    if (upstream_) return upstream_->find(id, type);
+    throw std::out_of_range("ArtifactStore::get() - no artifact " + std::to_string(id));
+}
+
+bool ArtifactStore::contains(int id) const {
+    {
+        std::lock_guard lock(mutex_);
+        if (entries_.contains(id)) return true;
+    }
+    return upstream_ && upstream_->contains(id);
+}
+
+const ArtifactStore::Entry* ArtifactStore::lookup(int id) const {
+    auto it = entries_.find(id);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+bool ArtifactStore::adopt(const ArtifactStore& from, int id) {
+    std::optional<Entry> entry;
+    for (const ArtifactStore* store = &from; store && !entry; store = store->upstream_.get()) {
+        std::lock_guard lock(store->mutex_);
+        if (const Entry* found = store->lookup(id)) entry = *found;
+    }
+    if (!entry) return false;
+
+    std::lock_guard lock(mutex_);
+    if (entries_.insert_or_assign(id, std::move(*entry)).second) {
+        stats_.live = entries_.size();
+        stats_.peakLive = std::max(stats_.peakLive, stats_.live);
+    }
+    return true;
+}
+
+void ArtifactStore::expect(int id, std::uint32_t consumers) {
+    std::lock_guard lock(mutex_);
+    remaining_[id] = consumers;
+}
+
+void ArtifactStore::pin(int id) {
+    std::lock_guard lock(mutex_);
+    pinned_.insert(id);
+}
+
+void ArtifactStore::consumed(int id) noexcept {
+    std::lock_guard lock(mutex_);
+    if (pinned_.contains(id)) return;
+    auto it = remaining_.find(id);
+    if (it == remaining_.end() || it->second == 0 || --it->second > 0) return;
+    // Readers still holding a view keep the object alive
+    if (entries_.erase(id) > 0) {
+        ++stats_.released;
+        stats_.live = entries_.size();
+    }
+}
+
+ArtifactStore::Stats ArtifactStore::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+} // namespace eden
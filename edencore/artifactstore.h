@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace eden {
+
+/**
+ * @brief Immutable task outputs of one workflow run, keyed by output ID
+ * @details A producer publishes its result under its ITask::outputID(); consumers
+ * (tasks whose inputID() is that id) read it. Values are type-erased and reference
+ * counted: get<T>() hands out a shared_ptr<const T> to the stored object, never a copy,
+ * and a reader keeps its view alive even after the store lets the artifact go.
+ *
+ * The run tells the store how many consumers each artifact has (expect()) and reports
+ * each one as it completes (consumed()); the artifact is dropped after the last, so an
+ * intermediate buffer does not outlive its readers. Artifacts nobody in the run
+ * consumes are the run's outputs and stay until the store goes.
+ *
+ * A store may have an upstream store whose artifacts it can read, but never releases
+ * (scenario runs reading the shared prefix of Workflow::runScenarios). A run can also
+ * adopt single artifacts of an earlier run's store, for the tasks it reuses
+ * (incremental runs).
+ *
+ * Thread-safe.
+ */
+class ArtifactStore {
+public:
+    struct Stats {
+        std::uint64_t published = 0;
+        std::uint64_t released = 0;
+        std::size_t live = 0;
+        std::size_t peakLive = 0;
+    };
+
+    explicit ArtifactStore(std::shared_ptr<const ArtifactStore> upstream = nullptr) noexcept
+        : upstream_(std::move(upstream)) {}
+
+    ArtifactStore(const ArtifactStore&) = delete;
+    ArtifactStore& operator=(const ArtifactStore&) = delete;
+
+    /// Move value into the store; returns the view consumers will get
+    template <class T>
+    std::shared_ptr<const T> publish(int id, T value) {
+        auto shared = std::make_shared<const T>(std::move(value));
+        publish(id, shared);
+        return shared;
+    }
+
+    /// Share an existing object, without copying it (a retried producer replaces it)
+    template <class T>
+    void publish(int id, std::shared_ptr<const T> value) {
+        if (!value) throw std::invalid_argument("ArtifactStore::publish() - null artifact " + std::to_string(id));
+        store(id, std::shared_ptr<const void>(std::move(value)), typeid(T));
+    }
+
+    /// Read-only view; throws std::out_of_range when missing, std::invalid_argument for another type
+    template <class T>
+    [[nodiscard]] std::shared_ptr<const T> get(int id) const {
+        return std::static_pointer_cast<const T>(find(id, typeid(T)));
+    }
+
+    [[nodiscard]] bool contains(int id) const;
+
+    /// Share from's artifact id (or its upstream's), if it has one; returns whether it had
+    bool adopt(const ArtifactStore& from, int id);
+
+    // Set by the run before it starts: the artifact id goes once `consumers` reported
+    // consumed(); pinned artifacts are kept for consumers outside the run
+    void expect(int id, std::uint32_t consumers);
+    void pin(int id);
+    void consumed(int id) noexcept;
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const void> value;
+        std::type_index type;
+    };
+
+    void store(int id, std::shared_ptr<const void> value, std::type_index type);
+    std::shared_ptr<const void> find(int id, std::type_index type) const;
+    const Entry* lookup(int id) const;  // under mutex_
+
+    std::shared_ptr<const ArtifactStore> upstream_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<int, Entry> entries_;
+    std::unordered_map<int, std::uint32_t> remaining_;
+    std::unordered_set<int> pinned_;
+    Stats stats_;
+};
+
+using ArtifactStoreSPtr = std::shared_ptr<ArtifactStore>;
+
+} // namespace eden
@@ -40,4 +40,14 @@ bool Attributes::operator==(const Attributes& other) const {
 // Inequality operator
 bool Attributes::operator!=(const Attributes& other) const {
     return !(*this == other);
-}
\ No newline at end of file
+}
+
+// The calendar date (yyyymmdd) and the time of day in seconds, both local as
+// DateTime(year, month, day) is: system_clock's tick differs between standard
+// libraries, and the epoch offset of a local midnight between time zones
+Fingerprint Attributes::fingerprint() const {
+    const std::tm tm = cob_.timepointToLocalTime();
+    const int date = (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+    const int seconds = tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+    return Hasher().add(date).add(seconds).value();
+}
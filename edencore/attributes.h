@@ -2,6 +2,7 @@
 
 #include "core.h"
 #include "datetime.h"
+#include "hash.h"
 
 namespace eden {
 
@@ -34,6 +35,9 @@ public:
     bool operator!=(const Attributes& other) const;
     // Getter for cob
     _ALWAYS_INLINE_ const DateTime& cob() const { return cob_; }
+    // Content fingerprint, used to detect changed inputs between runs: the COB's
+    // local date and time of day. Subclasses adding fields mix them in.
+    virtual Fingerprint fingerprint() const;
 };
 
 using AttributeSPtr = std::shared_ptr<Attributes>;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <thread>
 
 namespace eden {
@@ -19,4 +20,17 @@ namespace eden {
 //   }
 // };
 
+/// Scheduling priority of a job; executors without priority support ignore it
+enum class JobPriority : std::uint8_t {
+    Low,
+    Normal,
+    High,
+    Critical
+};
+
+inline constexpr std::size_t kJobPriorityCount = 4;
+
+/// Handle of a delayed or periodic job (IThreadExecutor::enqueueAfter/enqueueEvery), 0 is never used
+using TimerId = std::uint64_t;
+
 } // namespace eden
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "hash.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <span>
 #include <stdexcept>
 #include <string>
 
@@ -17,6 +19,10 @@ public:
     T get(const std::string& /*key*/) const {
         throw std::runtime_error("get() is not implemented!");
     }
+
+    /// Fingerprint of the values under keys, or of the whole context when keys is empty.
+    /// A context without data always gives the same value.
+    virtual Fingerprint fingerprint(std::span<const std::string> /*keys*/) const { return Hasher().value(); }
 };
 
 class TaskContext : public IContext {
@@ -35,9 +41,13 @@ public:
 class JsonContext : public IContext {
 private:
     nlohmann::json data_;
+    // Kept up to date by the constructors and set(), so that concurrent runs only read it
+    Fingerprint wholeFingerprint_ = 0;
+
+    void rehash() { wholeFingerprint_ = Hasher().add(data_.dump()).value(); }
 
 public:
-    JsonContext() = default;
+    JsonContext() { rehash(); }
     virtual ~JsonContext() = default;
 
     /// Load the entire JSON config at startup.
@@ -46,6 +56,7 @@ public:
         if (!in) 
             throw std::runtime_error("Cannot open config file: " + filepath);
         in >> data_;
+        rehash();
     }
 
     /// Query any key from the root object. Throws if missing or wrong type.
@@ -58,6 +69,25 @@ public:
 
     /// Access the raw JSON if you need nested lookups.
     const nlohmann::json& raw() const noexcept { return data_; }
+
+    /// Replace one value, between runs (a running workflow reads the context concurrently).
+    template<typename T>
+    void set(const std::string& key, T&& value) {
+        data_[key] = std::forward<T>(value);
+        rehash();
+    }
+
+    /// Keys missing from the document hash as null.
+    Fingerprint fingerprint(std::span<const std::string> keys) const override {
+        // Every task without a declared slice asks for this one: hashed once
+        if (keys.empty()) return wholeFingerprint_;
+        Hasher hasher;
+        for (const auto& key : keys) {
+            auto it = data_.find(key);
+            hasher.add(key).add(it == data_.end() ? std::string("null") : it->dump());
+        }
+        return hasher.value();
+    }
 };
 
 using ContextSPtr = std::shared_ptr<IContext>;
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency.h"
+#include "threadpool.h"
+
+namespace eden {
+
+/**
+ * @brief Coroutines on top of IThreadExecutor
+ * @details Task<T> is a lazy coroutine: it starts when awaited and resumes its awaiter
+ * when it finishes (symmetric transfer, so long chains do not grow the stack).
+ * A coroutine moves to an executor with `co_await schedule_on(executor)`; while it
+ * waits on something else it is just a heap frame and holds no thread, so far more
+ * tasks can be in flight than there are workers.
+ *
+ * when_all / when_any start a set of tasks together, sync_wait blocks a plain thread
+ * on a task, and start_detached runs one in the background with a completion callback.
+ *
+ * A coroutine suspended in schedule_on is resumed by a pool job: destroying the
+ * executor with such jobs still queued leaks their frames.
+ * As with any coroutine, a lambda coroutine must not capture: the closure is gone by
+ * the time the body resumes. Pass what it needs as parameters instead.
+ */
+template <class T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    // Resumed when the task finishes; nothing for a task that was never awaited
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <class T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <class U>
+        requires std::is_convertible_v<U&&, T>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void result() const {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// Fire-and-forget coroutine: runs eagerly and frees its own frame at the end.
+// Bodies catch everything themselves.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using value_type = T;
+
+    Task() noexcept = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    [[nodiscard]] bool valid() const noexcept { return static_cast<bool>(handle_); }
+    [[nodiscard]] bool done() const noexcept { return handle_ && handle_.done(); }
+
+    auto operator co_await() const& noexcept { return Awaiter{handle_}; }
+    auto operator co_await() const&& noexcept { return Awaiter{handle_}; }
+
+private:
+    struct Awaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        T await_resume() {
+            if (!handle) throw std::logic_error("Task: awaiting an empty task");
+            return handle.promise().result();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <class T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/// Awaitable moving the awaiting coroutine onto executor (always suspends, even on a worker)
+class ScheduleOn {
+public:
+    ScheduleOn(IThreadExecutor& executor, JobPriority priority) noexcept
+      : executor_(executor), priority_(priority) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        executor_.enqueue([h] { h.resume(); }, priority_);
+    }
+    void await_resume() const noexcept {}
+
+private:
+    IThreadExecutor& executor_;
+    JobPriority priority_;
+};
+
+inline ScheduleOn schedule_on(IThreadExecutor& executor, JobPriority priority = JobPriority::Normal) noexcept {
+    return {executor, priority};
+}
+
+/// Run task in the background; then(std::exception_ptr) is called on the thread that finishes it
+template <class Then>
+void start_detached(Task<void> task, Then then) {
+    [](Task<void> t, Then done) -> detail::Detached {
+        std::exception_ptr error;
+        try {
+            co_await t;
+        } catch (...) {
+            error = std::current_exception();
+        }
+        done(error);
+    }(std::move(task), std::move(then));
+}
+
+/// Block the calling thread until task finishes; must not be called from a coroutine
+template <class T>
+T sync_wait(Task<T> task) {
+    struct State {
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+        std::optional<std::conditional_t<std::is_void_v<T>, char, T>> value;
+    };
+    // Shared with the driver, which may still touch it after the waiter returns
+    auto state = std::make_shared<State>();
+
+    [](Task<T> t, std::shared_ptr<State> s) -> detail::Detached {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await t;
+            } else {
+                s->value.emplace(co_await t);
+            }
+        } catch (...) {
+            s->error = std::current_exception();
+        }
+        s->done.store(true, std::memory_order_release);
+        s->done.notify_all();
+    }(std::move(task), state);
+
+    state->done.wait(false, std::memory_order_acquire);
+    if (state->error) std::rethrow_exception(state->error);
+    if constexpr (!std::is_void_v<T>) return std::move(*state->value);
+}
+
+namespace detail {
+
+/*
+Starting a group of tasks while the parent is suspended:
+the children are started from await_suspend and may finish, on other threads, before
+the loop is over. A gate counter holds one extra reference for the starter: whoever
+drops it to zero, the last child or the starter itself, resumes the parent. When it is
+the starter, await_suspend returns false and the parent simply does not suspend.
+*/
+template <class T>
+struct AllState {
+    explicit AllState(std::size_t n) : gate(n + 1), values(n) {}
+
+    std::atomic<std::size_t> gate;
+    std::coroutine_handle<> parent;
+    std::atomic<bool> failed{false};
+    // Written once, by the child that sets failed
+    std::exception_ptr error;
+    std::vector<std::optional<std::conditional_t<std::is_void_v<T>, char, T>>> values;
+
+    void arrive() {
+        if (gate.fetch_sub(1, std::memory_order_acq_rel) == 1) parent.resume();
+    }
+};
+
+template <class T>
+Detached runAllChild(Task<T> task, std::shared_ptr<AllState<T>> state, std::size_t index) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            state->values[index].emplace();
+        } else {
+            state->values[index].emplace(co_await task);
+        }
+    } catch (...) {
+        if (!state->failed.exchange(true, std::memory_order_relaxed)) state->error = std::current_exception();
+    }
+    state->arrive();
+}
+
+template <class T>
+struct AllAwaiter {
+    // References into the awaiting frame, not owning copies: GCC 12 releases an owning
+    // awaiter temporary too early when another thread resumes the coroutine
+    std::vector<Task<T>>& tasks;
+    const std::shared_ptr<AllState<T>>& state;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+    bool await_suspend(std::coroutine_handle<> h) {
+        state->parent = h;
+        for (std::size_t i = 0; i < tasks.size(); ++i) runAllChild(std::move(tasks[i]), state, i);
+        return state->gate.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+};
+
+template <class T>
+struct AnyState {
+    static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+    // One for the winner, one for the starter
+    std::atomic<int> gate{2};
+    std::atomic<std::size_t> winner{kNone};
+    std::coroutine_handle<> parent;
+    std::exception_ptr error;
+    std::optional<std::conditional_t<std::is_void_v<T>, char, T>> value;
+
+    void arrive() {
+        if (gate.fetch_sub(1, std::memory_order_acq_rel) == 1) parent.resume();
+    }
+};
+
+template <class T>
+Detached runAnyChild(Task<T> task, std::shared_ptr<AnyState<T>> state, std::size_t index) {
+    std::exception_ptr error;
+    std::optional<std::conditional_t<std::is_void_v<T>, char, T>> value;
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            value.emplace();
+        } else {
+            value.emplace(co_await task);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Only the first child to finish publishes; the others run to completion unnoticed
+    std::size_t none = AnyState<T>::kNone;
+    if (state->winner.compare_exchange_strong(none, index, std::memory_order_acq_rel)) {
+        state->error = error;
+        state->value = std::move(value);
+        state->arrive();
+    }
+}
+
+template <class T>
+struct AnyAwaiter {
+    // References into the awaiting frame, not owning copies: GCC 12 releases an owning
+    // awaiter temporary too early when another thread resumes the coroutine
+    std::vector<Task<T>>& tasks;
+    const std::shared_ptr<AnyState<T>>& state;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) {
+        state->parent = h;
+        for (std::size_t i = 0; i < tasks.size(); ++i) runAnyChild(std::move(tasks[i]), state, i);
+        return state->gate.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * Run every task concurrently (each one up to its first suspension on the awaiting
+ * thread) and resume once all are done. Results keep the order of the input; the first
+ * exception is rethrown after all tasks have finished.
+ */
+template <class T>
+    requires (!std::is_void_v<T>)
+Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+    auto state = std::make_shared<detail::AllState<T>>(tasks.size());
+    co_await detail::AllAwaiter<T>{tasks, state};
+    if (state->error) std::rethrow_exception(state->error);
+
+    std::vector<T> results;
+    results.reserve(state->values.size());
+    for (auto& value : state->values) results.push_back(std::move(*value));
+    co_return results;
+}
+
+inline Task<void> when_all(std::vector<Task<void>> tasks) {
+    auto state = std::make_shared<detail::AllState<void>>(tasks.size());
+    co_await detail::AllAwaiter<void>{tasks, state};
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+/// Index and result of the first task to finish (or its exception).
+/// The other tasks keep running to completion; throws std::invalid_argument when empty.
+template <class T>
+    requires (!std::is_void_v<T>)
+Task<std::pair<std::size_t, T>> when_any(std::vector<Task<T>> tasks) {
+    if (tasks.empty()) throw std::invalid_argument("when_any: no task");
+    auto state = std::make_shared<detail::AnyState<T>>();
+    co_await detail::AnyAwaiter<T>{tasks, state};
+    if (state->error) std::rethrow_exception(state->error);
+    co_return std::pair<std::size_t, T>{state->winner.load(std::memory_order_acquire), std::move(*state->value)};
+}
+
+/// Index of the first task to finish
+inline Task<std::size_t> when_any(std::vector<Task<void>> tasks) {
+    if (tasks.empty()) throw std::invalid_argument("when_any: no task");
+    auto state = std::make_shared<detail::AnyState<void>>();
+    co_await detail::AnyAwaiter<void>{tasks, state};
+    if (state->error) std::rethrow_exception(state->error);
+    co_return state->winner.load(std::memory_order_acquire);
+}
+
+} // namespace eden
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "coroutine.h"
+#include "itask.h"
+#include <stop_token>
+
+namespace eden {
+
+/**
+ * @brief ITask whose body is a coroutine
+ * @details Derived tasks implement runAsync() instead of run(). Workflow::run starts the
+ * coroutine and lets the worker go as soon as it suspends: the task's dependents are
+ * released by whichever thread resumes it last. Called directly, run() blocks until
+ * the coroutine has finished.
+ *
+ * The task's policy applies as for any task: retries, and a timeout that requests the
+ * stop token given to runAsyncCancellable(). Aborting or cancelling the run requests
+ * it too. The attempt is judged once the coroutine finishes, so one that never looks
+ * at its token still holds the run until it does.
+ */
+class CoroutineTask : public ITask {
+public:
+    using ITask::ITask;
+
+    virtual Task<void> runAsync(const AttributeSPtr& attrs, const ContextSPtr& ctx) = 0;
+
+    // What Workflow::run starts. Long coroutines override it and return early once
+    // stop is requested (timeout, aborted or cancelled run); the default ignores the token.
+    virtual Task<void> runAsyncCancellable(const AttributeSPtr& attrs, const ContextSPtr& ctx,
+                                           std::stop_token /*stop*/) {
+        return runAsync(attrs, ctx);
+    }
+
+    void run(const AttributeSPtr& attrs, const ContextSPtr& ctx) override {
+        sync_wait(runAsync(attrs, ctx));
+    }
+};
+
+} // namespace eden
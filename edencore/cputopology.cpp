@@ -0,0 +1,173 @@
+#include "cputopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace eden {
+
+#ifdef __linux__
+static_assert(CpuTopology::kMaxCpus <= CPU_SETSIZE, "parsed CPU ids must fit in a cpu_set_t");
+#endif
+
+namespace {
+
+std::optional<std::string> readLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) return std::nullopt;
+    return line;
+}
+
+std::optional<unsigned> readUnsigned(const std::string& path) {
+    auto line = readLine(path);
+    if (!line) return std::nullopt;
+    try {
+        // Some hypervisors report -1 for an unknown package
+        const long value = std::stol(*line);
+        if (value < 0) return std::nullopt;
+        return static_cast<unsigned>(value);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+CpuTopology::CpuTopology(std::vector<LogicalCpu> cpus) : cpus_(std::move(cpus)) {
+    std::sort(cpus_.begin(), cpus_.end(), [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; });
+
+    std::set<std::pair<unsigned, unsigned>> cores;
+    std::set<unsigned> packages;
+    std::set<unsigned> nodes;
+    for (const auto& cpu : cpus_) {
+        cores.emplace(cpu.package, cpu.core);
+        packages.insert(cpu.package);
+        nodes.insert(cpu.numaNode);
+    }
+    cores_ = cores.size();
+    packages_ = packages.size();
+    numaNodes_ = nodes.size();
+}
+
+CpuTopology CpuTopology::flat(std::size_t n) {
+    std::vector<LogicalCpu> cpus(n == 0 ? 1 : n);
+    for (unsigned i = 0; i < cpus.size(); ++i) {
+        cpus[i].id = i;
+        cpus[i].core = i;
+    }
+    return CpuTopology(std::move(cpus));
+}
+
+std::vector<unsigned> CpuTopology::parseCpuList(const std::string& list) {
+    std::vector<unsigned> ids;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        try {
+            const auto dash = range.find('-');
+            const unsigned long first = std::stoul(range.substr(0, dash));
+            const unsigned long last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            if (first > last || last >= kMaxCpus) continue;
+            for (unsigned long id = first; id < last + 1; ++id) ids.push_back(static_cast<unsigned>(id));
+        } catch (const std::exception&) {
+            // Ignore malformed entries, the rest of the list is still usable
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+std::vector<unsigned> CpuTopology::allowedCpus() {
+    std::vector<unsigned> ids;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return ids;
+    for (unsigned id = 0; id < CPU_SETSIZE; ++id) {
+        if (CPU_ISSET(id, &set)) ids.push_back(id);
+    }
+#endif
+    return ids;
+}
+
+CpuTopology CpuTopology::detect(const std::string& sysRoot) {
+    const auto allowed = allowedCpus();
+    return detect(sysRoot, allowed);
+}
+
+CpuTopology CpuTopology::detect(const std::string& sysRoot, std::span<const unsigned> allowed) {
+    const auto online = readLine(sysRoot + "/cpu/online");
+    auto ids = online ? parseCpuList(*online) : std::vector<unsigned>{};
+    if (!allowed.empty()) {
+        // Pinning a worker outside the affinity mask (or cgroup cpuset) fails. When
+        // sysfs does not match the mask at all (sandboxes), the mask wins.
+        std::erase_if(ids, [&](unsigned id) { return std::find(allowed.begin(), allowed.end(), id) == allowed.end(); });
+        if (ids.empty()) ids.assign(allowed.begin(), allowed.end());
+    }
+    if (ids.empty()) {
+        const auto n = std::thread::hardware_concurrency();
+        return flat(n == 0 ? 1 : n);
+    }
+
+    std::vector<LogicalCpu> cpus;
+    cpus.reserve(ids.size());
+    for (unsigned id : ids) {
+        const std::string topo = sysRoot + "/cpu/cpu" + std::to_string(id) + "/topology/";
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpu.core = readUnsigned(topo + "core_id").value_or(id);
+        cpu.package = readUnsigned(topo + "physical_package_id").value_or(0);
+
+        // Rank among the hardware threads sharing this core
+        if (auto siblings = readLine(topo + "thread_siblings_list")) {
+            const auto list = parseCpuList(*siblings);
+            const auto it = std::find(list.begin(), list.end(), id);
+            if (it != list.end()) cpu.smtRank = static_cast<unsigned>(it - list.begin());
+        }
+        cpus.push_back(cpu);
+    }
+
+    // NUMA nodes list their CPUs; without a node directory everything stays on node 0
+    if (auto nodes = readLine(sysRoot + "/node/online")) {
+        for (unsigned node : parseCpuList(*nodes)) {
+            auto cpuList = readLine(sysRoot + "/node/node" + std::to_string(node) + "/cpulist");
+            if (!cpuList) continue;
+            for (unsigned id : parseCpuList(*cpuList)) {
+                auto it = std::find_if(cpus.begin(), cpus.end(), [id](const LogicalCpu& c) { return c.id == id; });
+                if (it != cpus.end()) it->numaNode = node;
+            }
+        }
+    }
+
+    return CpuTopology(std::move(cpus));
+}
+
+bool pinCurrentThread(std::span<const unsigned> cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    // macOS only offers affinity hints (thread_policy_set), not hard pinning
+    (void)cpus;
+    return false;
+#endif
+}
+
+} // namespace eden
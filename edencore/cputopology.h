@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace eden {
+
+/// One logical CPU (hardware thread) as numbered by the OS
+struct LogicalCpu {
+    unsigned id = 0;        // OS cpu number, as used in affinity masks
+    unsigned core = 0;      // core_id, unique within its package
+    unsigned package = 0;   // physical package (socket)
+    unsigned numaNode = 0;
+    unsigned smtRank = 0;   // 0 for the first hardware thread of its core, 1 for its SMT sibling, ...
+};
+
+/**
+ * @brief Snapshot of the machine's CPU, socket and NUMA layout
+ * @details Read from sysfs on Linux (cpu/online, cpuN/topology, node/nodeK/cpulist),
+ * limited to the CPUs the process may run on: its affinity mask, which also reflects
+ * a container's cgroup cpuset. Anything that cannot be read falls back to a flat
+ * layout: hardware_concurrency() CPUs, one core each, on a single package and NUMA node.
+ */
+class CpuTopology {
+public:
+    // Highest CPU number + 1 taken from a cpu list (CPU_SETSIZE on Linux)
+    static constexpr unsigned kMaxCpus = 1024;
+
+    // sysRoot is the /sys/devices/system directory; tests point it at a fake tree.
+    // Only the online CPUs in allowed are kept (empty: no restriction).
+    static CpuTopology detect(const std::string& sysRoot = "/sys/devices/system");
+    static CpuTopology detect(const std::string& sysRoot, std::span<const unsigned> allowed);
+
+    // CPUs in the calling process's affinity mask, sorted; empty where it cannot be read
+    static std::vector<unsigned> allowedCpus();
+
+    // Flat layout of n CPUs, also what detect() returns without sysfs
+    static CpuTopology flat(std::size_t n);
+
+    // Parse a kernel cpu list such as "0-3,8,10-11"; malformed entries and ranges
+    // reaching kMaxCpus are dropped
+    static std::vector<unsigned> parseCpuList(const std::string& list);
+
+    // Sorted by id
+    [[nodiscard]] const std::vector<LogicalCpu>& cpus() const noexcept { return cpus_; }
+    [[nodiscard]] std::size_t coreCount() const noexcept { return cores_; }
+    [[nodiscard]] std::size_t packageCount() const noexcept { return packages_; }
+    [[nodiscard]] std::size_t numaNodeCount() const noexcept { return numaNodes_; }
+
+private:
+    explicit CpuTopology(std::vector<LogicalCpu> cpus);
+
+    std::vector<LogicalCpu> cpus_;
+    std::size_t cores_ = 0;
+    std::size_t packages_ = 0;
+    std::size_t numaNodes_ = 0;
+};
+
+// Restrict the calling thread to the given CPUs. Returns false where thread
+// affinity is not supported (non-Linux) or the kernel rejects the mask.
+bool pinCurrentThread(std::span<const unsigned> cpus);
+
+} // namespace eden
@@ -94,7 +94,10 @@ public:
         auto in_time_t = std::chrono::system_clock::to_time_t(time_point_);
         // seems not working - C++20 not fully settled on MacOS
         // return std::format("{:%Y-%m-%d %H:%M:%S}", *std::localtime(&in_time_t));
-        std::tm tm = *std::localtime(&in_time_t);
+        // localtime_r: std::localtime shares one static buffer between threads, and
+        // Attributes::fingerprint calls this while concurrent runs are launched
+        std::tm tm{};
+        localtime_r(&in_time_t, &tm);
         return tm;
     }
 
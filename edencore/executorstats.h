@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Log2-bucketed latency histogram in nanoseconds
+ * @details Bucket 0 counts 0 ns, bucket i counts values in [2^(i-1), 2^i).
+ * Coarse (a factor of two per bucket) but fixed size and cheap to record,
+ * which is what the executor needs on its hot path.
+ */
+struct LatencyHistogram {
+    // 2^39 ns is about 9 minutes, anything longer lands in the last bucket
+    static constexpr std::size_t kBuckets = 40;
+
+    std::array<std::uint64_t, kBuckets> counts{};
+
+    static std::size_t bucketFor(std::uint64_t ns) noexcept {
+        const auto bucket = static_cast<std::size_t>(std::bit_width(ns));
+        return bucket < kBuckets ? bucket : kBuckets - 1;
+    }
+
+    // Exclusive upper bound of a bucket
+    static std::uint64_t bucketLimitNs(std::size_t bucket) noexcept {
+        return bucket == 0 ? 1 : std::uint64_t{1} << bucket;
+    }
+
+    [[nodiscard]] std::uint64_t total() const noexcept {
+        std::uint64_t n = 0;
+        for (auto c : counts) n += c;
+        return n;
+    }
+
+    // Upper bound of the bucket holding the given quantile (0..1), 0 when empty
+    [[nodiscard]] std::uint64_t quantileNs(double q) const noexcept {
+        const std::uint64_t n = total();
+        if (n == 0) return 0;
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return bucketLimitNs(i);
+        }
+        return bucketLimitNs(kBuckets - 1);
+    }
+
+    LatencyHistogram& operator+=(const LatencyHistogram& other) noexcept {
+        for (std::size_t i = 0; i < kBuckets; ++i) counts[i] += other.counts[i];
+        return *this;
+    }
+};
+
+/// Counters of one worker thread
+struct WorkerStats {
+    std::uint64_t jobs = 0;
+    // Jobs taken from another worker's deque (WorkStealing mode)
+    std::uint64_t steals = 0;
+    // Jobs that exited with an exception
+    std::uint64_t exceptions = 0;
+    // Time spent running jobs back to back, and with nothing to run
+    std::chrono::nanoseconds busy{0};
+    std::chrono::nanoseconds idle{0};
+    // Jobs in the worker's own deque at snapshot time (WorkStealing mode)
+    std::int64_t localQueue = 0;
+    // Time between enqueue and start, for a sample of the jobs this worker ran
+    LatencyHistogram queueWait;
+};
+
+/**
+ * @brief Point-in-time view of an executor's counters
+ * @details Taken without stopping the workers: each counter is read atomically,
+ * but the snapshot as a whole is not, so totals may be off by the few jobs
+ * running while it is taken.
+ */
+struct ExecutorStats {
+    std::vector<WorkerStats> workers;
+    // Jobs published but not started yet
+    std::int64_t queued = 0;
+
+    [[nodiscard]] std::uint64_t jobs() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers) n += w.jobs;
+        return n;
+    }
+
+    [[nodiscard]] std::uint64_t steals() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers) n += w.steals;
+        return n;
+    }
+
+    [[nodiscard]] std::uint64_t exceptions() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers) n += w.exceptions;
+        return n;
+    }
+
+    [[nodiscard]] LatencyHistogram queueWait() const noexcept {
+        LatencyHistogram h;
+        for (const auto& w : workers) h += w.queueWait;
+        return h;
+    }
+
+    // Share of worker time spent running jobs, 0..1
+    [[nodiscard]] double utilisation() const noexcept {
+        std::chrono::nanoseconds busy{0};
+        std::chrono::nanoseconds all{0};
+        for (const auto& w : workers) {
+            busy += w.busy;
+            all += w.busy + w.idle;
+        }
+        return all.count() == 0 ? 0.0 : static_cast<double>(busy.count()) / static_cast<double>(all.count());
+    }
+};
+
+// One line per worker plus the totals
+inline std::ostream& operator<<(std::ostream& os, const ExecutorStats& stats) {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    const auto wait = stats.queueWait();
+    os << "queued: " << stats.queued << " jobs: " << stats.jobs() << " steals: " << stats.steals()
+       << " exceptions: " << stats.exceptions() << " utilisation: " << stats.utilisation() * 100 << "%"
+       << " wait p50 < " << wait.quantileNs(0.5) << "ns p99 < " << wait.quantileNs(0.99) << "ns\n";
+    for (std::size_t i = 0; i < stats.workers.size(); ++i) {
+        const auto& w = stats.workers[i];
+        os << "  worker " << i << ": jobs " << w.jobs << " steals " << w.steals << " exceptions " << w.exceptions
+           << " busy " << duration_cast<milliseconds>(w.busy).count() << "ms"
+           << " idle " << duration_cast<milliseconds>(w.idle).count() << "ms"
+           << " local queue " << w.localQueue << "\n";
+    }
+    return os;
+}
+
+} // namespace eden
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace eden {
+
+/**
+ * @brief 64-bit content fingerprint
+ * @details Stable across processes and platforms (FNV-1a over the bytes, values
+ * folded in little-endian order), so it can be stored next to the results it
+ * describes and compared on a later run. Not a cryptographic hash.
+ */
+using Fingerprint = std::uint64_t;
+
+class Hasher {
+public:
+    static constexpr Fingerprint kOffset = 0xcbf29ce484222325ull;
+    static constexpr Fingerprint kPrime = 0x100000001b3ull;
+
+    constexpr Hasher() noexcept = default;
+    constexpr explicit Hasher(Fingerprint seed) noexcept : state_(seed) {}
+
+    constexpr Hasher& bytes(const void* data, std::size_t size) noexcept {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            state_ = (state_ ^ p[i]) * kPrime;
+        }
+        return *this;
+    }
+
+    // The length goes first: ("ab", "c") and ("a", "bc") differ
+    constexpr Hasher& add(std::string_view text) noexcept {
+        add(static_cast<std::uint64_t>(text.size()));
+        for (char c : text) state_ = (state_ ^ static_cast<unsigned char>(c)) * kPrime;
+        return *this;
+    }
+
+    template <class T>
+        requires(std::is_integral_v<T> || std::is_enum_v<T>)
+    constexpr Hasher& add(T value) noexcept {
+        auto v = static_cast<std::uint64_t>(value);
+        for (int i = 0; i < 8; ++i, v >>= 8) state_ = (state_ ^ (v & 0xff)) * kPrime;
+        return *this;
+    }
+
+    // -0.0 and 0.0 compare equal, so they hash equal
+    constexpr Hasher& add(double value) noexcept {
+        return add(value == 0.0 ? std::uint64_t{0} : std::bit_cast<std::uint64_t>(value));
+    }
+
+    [[nodiscard]] constexpr Fingerprint value() const noexcept { return state_; }
+
+private:
+    Fingerprint state_ = kOffset;
+};
+
+} // namespace eden
@@ -0,0 +1,119 @@
+#include "hazardpointer.h"
+
+#include <algorithm>
+
+namespace eden {
+
+HazardPointerDomain::~HazardPointerDomain() {
+    // Nobody can be protecting anything any more
+    HazardPointerObject* obj = retired_.exchange(nullptr, std::memory_order_acquire);
+    while (obj) {
+        HazardPointerObject* next = obj->retiredNext_;
+        obj->reclaimFn_(obj, obj->reclaimCtx_);
+        obj = next;
+    }
+
+    Record* record = records_.load(std::memory_order_acquire);
+    while (record) {
+        Record* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+HazardPointerDomain::Record* HazardPointerDomain::acquireRecord() {
+    // Reuse a released slot if there is one
+    for (Record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (!r->active.load(std::memory_order_relaxed) &&
+            r->active.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return r;
+        }
+    }
+
+    // Otherwise add a new one; the list is push-only so this CAS cannot suffer ABA
+    auto* record = new Record();
+    record->active.store(true, std::memory_order_relaxed);
+    Record* head = records_.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records_.compare_exchange_weak(
+        head, record, std::memory_order_release, std::memory_order_relaxed));
+    recordCount_.fetch_add(1, std::memory_order_relaxed);
+    return record;
+}
+
+void HazardPointerDomain::releaseRecord(Record* record) noexcept {
+    record->hazard.store(nullptr, std::memory_order_release);
+    record->active.store(false, std::memory_order_release);
+}
+
+std::size_t HazardPointerDomain::threshold() const noexcept {
+    // Amortise each scan over several retirements per slot
+    return std::max<std::size_t>(64, 2 * recordCount_.load(std::memory_order_relaxed));
+}
+
+void HazardPointerDomain::retireObject(
+    HazardPointerObject* obj, const void* key, HazardPointerObject::ReclaimFn fn, void* ctx) {
+    obj->reclaimFn_ = fn;
+    obj->reclaimCtx_ = ctx;
+    obj->hazardKey_ = key;
+
+    HazardPointerObject* head = retired_.load(std::memory_order_relaxed);
+    do {
+        obj->retiredNext_ = head;
+    } while (!retired_.compare_exchange_weak(
+        head, obj, std::memory_order_release, std::memory_order_relaxed));
+
+    if (retiredCount_.fetch_add(1, std::memory_order_relaxed) + 1 >= threshold()) {
+        reclaim();
+    }
+}
+
+void HazardPointerDomain::reclaim() {
+    // A concurrent scan will pick up our objects, no need to wait for it
+    std::unique_lock lock(reclaimMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    // Take the whole retired list; exchange is immune to ABA
+    HazardPointerObject* list = retired_.exchange(nullptr, std::memory_order_acquire);
+    if (!list) return;
+
+    // Snapshot every published hazard
+    scratch_.clear();
+    for (Record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+        if (const void* p = r->hazard.load(std::memory_order_seq_cst)) {
+            scratch_.push_back(p);
+        }
+    }
+    std::sort(scratch_.begin(), scratch_.end());
+
+    std::size_t reclaimed = 0;
+    HazardPointerObject* keep = nullptr;
+    while (list) {
+        HazardPointerObject* next = list->retiredNext_;
+        if (std::binary_search(scratch_.begin(), scratch_.end(), list->hazardKey_)) {
+            // Still protected: try again on a later scan
+            list->retiredNext_ = keep;
+            keep = list;
+        } else {
+            list->reclaimFn_(list, list->reclaimCtx_);
+            ++reclaimed;
+        }
+        list = next;
+    }
+    retiredCount_.fetch_sub(reclaimed, std::memory_order_relaxed);
+
+    // Put the survivors back
+    while (keep) {
+        HazardPointerObject* next = keep->retiredNext_;
+        HazardPointerObject* head = retired_.load(std::memory_order_relaxed);
+        do {
+            keep->retiredNext_ = head;
+        } while (!retired_.compare_exchange_weak(
+            head, keep, std::memory_order_release, std::memory_order_relaxed));
+        keep = next;
+    }
+}
+
+} // namespace eden
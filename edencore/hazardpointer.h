@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Intrusive hook for objects reclaimed through a HazardPointerDomain
+ * @details Retiring does not allocate: the retired list is threaded through the
+ * objects themselves, and the reclaim function decides what "free" means
+ * (delete, or hand the node back to a NodePool).
+ */
+struct HazardPointerObject {
+    using ReclaimFn = void (*)(HazardPointerObject* obj, void* ctx);
+
+    HazardPointerObject* retiredNext_ = nullptr;
+    ReclaimFn reclaimFn_ = nullptr;
+    void* reclaimCtx_ = nullptr;
+    // Address readers protect (the most derived object, not this base subobject)
+    const void* hazardKey_ = nullptr;
+};
+
+/**
+ * @brief Hazard pointer domain (Michael, 2004)
+ * @details Safe memory reclamation for lock-free structures.
+ *
+ * A reader publishes the pointer it is about to dereference in a hazard slot
+ * (HazardPointer::protect). A writer that unlinks an object retires it instead of
+ * freeing it; retired objects are only reclaimed once no hazard slot points at them.
+ *
+ * This removes both classic lock-free hazards:
+ * - use-after-free: a protected node cannot be freed under the reader's feet
+ * - ABA: a protected node cannot be recycled and re-inserted, so a CAS that
+ *   expects it at the head cannot succeed on a different incarnation
+ *
+ * One domain per data structure owner (e.g. a ThreadPool) keeps reclaim
+ * callbacks from outliving their context.
+ */
+class HazardPointerDomain {
+public:
+    HazardPointerDomain() = default;
+    // Reclaims every object still retired; no thread may hold a hazard any more
+    ~HazardPointerDomain();
+
+    HazardPointerDomain(const HazardPointerDomain&) = delete;
+    HazardPointerDomain& operator=(const HazardPointerDomain&) = delete;
+
+    // Hand over an unlinked object; fn(obj, ctx) runs once it is no longer protected
+    template <class T>
+    void retire(T* obj, HazardPointerObject::ReclaimFn fn, void* ctx) {
+        retireObject(obj, static_cast<const void*>(obj), fn, ctx);
+    }
+
+    // Reclaim every retired object that is not currently protected
+    void reclaim();
+
+    [[nodiscard]] std::size_t retiredCount() const noexcept {
+        return retiredCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class HazardPointer;
+
+    // One hazard slot, owned by at most one HazardPointer at a time
+    struct alignas(64) Record {
+        std::atomic<const void*> hazard{nullptr};
+        std::atomic<bool> active{false};
+        Record* next = nullptr;
+    };
+
+    void retireObject(HazardPointerObject* obj, const void* key, HazardPointerObject::ReclaimFn fn, void* ctx);
+
+    Record* acquireRecord();
+    void releaseRecord(Record* record) noexcept;
+
+    // Reclaim is attempted once this many objects are waiting
+    std::size_t threshold() const noexcept;
+
+    // Push-only list of slots, never shrinks while the domain lives
+    std::atomic<Record*> records_{nullptr};
+    std::atomic<std::size_t> recordCount_{0};
+
+    // Lock-free list of retired objects
+    std::atomic<HazardPointerObject*> retired_{nullptr};
+    std::atomic<std::size_t> retiredCount_{0};
+
+    // Only one thread scans at a time; scratch_ is reused to avoid allocating
+    std::mutex reclaimMutex_;
+    std::vector<const void*> scratch_;
+};
+
+/**
+ * @brief RAII owner of one hazard slot
+ * @details Meant to be long-lived: a worker thread keeps one for its whole loop.
+ */
+class HazardPointer {
+public:
+    explicit HazardPointer(HazardPointerDomain& domain)
+      : domain_(domain), record_(domain.acquireRecord()) {}
+
+    ~HazardPointer() { domain_.releaseRecord(record_); }
+
+    HazardPointer(const HazardPointer&) = delete;
+    HazardPointer& operator=(const HazardPointer&) = delete;
+
+    // Load src and publish it as hazardous; loops until the published value is still current
+    template <class T>
+    T* protect(const std::atomic<T*>& src) noexcept {
+        T* p = src.load(std::memory_order_relaxed);
+        while (true) {
+            // seq_cst store + load: the reclaimer must see the slot before we re-check src
+            record_->hazard.store(p, std::memory_order_seq_cst);
+            T* current = src.load(std::memory_order_seq_cst);
+            if (current == p) return p;
+            p = current;
+        }
+    }
+
+    // Stop protecting anything
+    void reset() noexcept { record_->hazard.store(nullptr, std::memory_order_release); }
+
+private:
+    HazardPointerDomain& domain_;
+    HazardPointerDomain::Record* record_;
+};
+
+} // namespace eden
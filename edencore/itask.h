@@ -1,14 +1,61 @@
 #pragma once
 
+#include "artifactstore.h"
 #include "attributes.h"
+#include "concurrency.h"
 #include "context.h"
+#include "hash.h"
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace eden {
 
 using TaskID  = int32_t;
 
+/**
+ * @brief Retry and timeout settings of a task, applied by Workflow::run
+ * @details A failed attempt is retried up to maxAttempts in total. The retry is
+ * rescheduled on the executor after the backoff delay, and no thread sleeps while
+ * it waits. A timed out attempt gets its stop token requested. It fails with
+ * TaskTimeoutError once it returns. Cancellation is cooperative: a task that never
+ * looks at its token cannot be interrupted.
+ *
+ * Backoff and timeout need an executor with timers (IThreadExecutor::hasTimers).
+ * On one without, a retry is enqueued at once, with no backoff, and a timeout is
+ * only checked when the attempt returns.
+ */
+struct TaskPolicy {
+    // Attempts in total, the first one included
+    unsigned maxAttempts = 1;
+    // Delay before the second attempt, times backoffFactor for each next one, at most maxBackoff
+    std::chrono::milliseconds backoff{0};
+    double backoffFactor = 2.0;
+    std::chrono::milliseconds maxBackoff{std::chrono::minutes(1)};
+    // Per attempt (0: none)
+    std::chrono::milliseconds timeout{0};
+    // Wall clock from the start of the first attempt: no retry starts past it (0: none)
+    std::chrono::milliseconds deadline{0};
+
+    // Delay before the next attempt, once `failed` attempts have failed
+    std::chrono::milliseconds backoffAfter(unsigned failed) const noexcept {
+        double delay = static_cast<double>(backoff.count());
+        for (unsigned i = 1; i < failed && delay < static_cast<double>(maxBackoff.count()); ++i) delay *= backoffFactor;
+        return std::min(maxBackoff, std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(delay)));
+    }
+};
+
+class TaskTimeoutError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 /**
   * * @brief Interface for all tasks in the workflow.
   * * @details This interface defines the basic structure and behavior of task  * that can be executed within a workflow. Each task must implement the `run`
@@ -23,8 +70,21 @@ private:
     int inputID_;
     int outputID_;
 
+    // Scheduling hint forwarded to the executor by Workflow::run
+    JobPriority priority_ {JobPriority::Normal};
+
+    TaskPolicy policy_;
+
+    // Context keys the task reads; empty means the whole context
+    std::vector<std::string> contextKeys_;
+
+    // Reads the COB only, not what Attributes subclasses add (the scenario)
+    bool scenarioIndependent_ = false;
+
 public:
-    enum class Status { Pending, Running, Completed, Failed };
+    // Skipped: not run because an upstream task failed, the run was aborted, or the task
+    // is outside the part of the graph the run covers
+    enum class Status { Pending, Running, Completed, Failed, Skipped };
     Status status {ITask::Status::Pending};
 
     ITask() = delete;
@@ -40,17 +100,75 @@ public:
     // the global Context loaded from JSON.
     virtual void run(const AttributeSPtr& attrs, const ContextSPtr& ctx) = 0;
 
+    // What runWithArtifacts calls by default. Long tasks override it and return early
+    // once stop is requested (timeout, aborted run); the default ignores the token.
+    virtual void runCancellable(const AttributeSPtr& attrs, const ContextSPtr& ctx, std::stop_token /*stop*/) {
+        run(attrs, ctx);
+    }
+
+    // What Workflow::run calls, with the run's artifacts: a task exchanging data reads
+    // artifacts.get<T>(inputID()) and publishes under outputID(). The default has no
+    // use for them.
+    virtual void runWithArtifacts(const AttributeSPtr& attrs, const ContextSPtr& ctx, std::stop_token stop,
+                                  ArtifactStore& /*artifacts*/) {
+        runCancellable(attrs, ctx, std::move(stop));
+    }
+
     const TaskID& ID() const noexcept { return taskID_; }
     const int& inputID() const noexcept { return inputID_; }
     const int& outputID() const noexcept { return outputID_; }
     const std::string& name() const noexcept { return taskName_; }
 
+    JobPriority priority() const noexcept { return priority_; }
+    void setPriority(JobPriority priority) noexcept { priority_ = priority; }
+
+    const TaskPolicy& policy() const noexcept { return policy_; }
+    void setPolicy(const TaskPolicy& policy) {
+        if (policy.maxAttempts == 0) throw std::invalid_argument("TaskPolicy: maxAttempts must be at least 1");
+        policy_ = policy;
+    }
+
+    const std::vector<std::string>& contextKeys() const noexcept { return contextKeys_; }
+    void setContextKeys(std::vector<std::string> keys) { contextKeys_ = std::move(keys); }
+
+    // A scenario-independent task runs once for all the scenarios of a COB in
+    // Workflow::runScenarios; its fingerprint leaves the scenario out
+    bool scenarioIndependent() const noexcept { return scenarioIndependent_; }
+    void setScenarioIndependent(bool independent) noexcept { scenarioIndependent_ = independent; }
+
+    // Fingerprint of everything the task reads besides its upstream tasks: its name
+    // and ids, the attributes and its slice of the context. Two runs with the same
+    // fingerprint (and unchanged upstream) produce the same result, so an incremental
+    // Workflow::run can skip it. Tasks with parameters of their own mix them in.
+    virtual Fingerprint fingerprint(const AttributeSPtr& attrs, const ContextSPtr& ctx) const {
+        Hasher hasher;
+        hasher.add(taskName_).add(inputID_).add(outputID_);
+        if (!attrs) hasher.add(Fingerprint{0});
+        else hasher.add(scenarioIndependent_ ? attrs->Attributes::fingerprint() : attrs->fingerprint());
+        hasher.add(ctx ? ctx->fingerprint(contextKeys_) : Fingerprint{0});
+        return hasher.value();
+    }
+
+    // Result caching (Workflow::setResultCache). A task whose result can be stored
+    // returns it as bytes after run(); restoreResult() takes those bytes back instead
+    // of running and returns false if it cannot use them. The default opts out.
+    virtual std::optional<std::string> saveResult() const { return std::nullopt; }
+    virtual bool restoreResult(std::string_view /*bytes*/) { return false; }
+
+    // What Workflow::run calls on a cache hit or a resume, with the run's artifacts: a
+    // task exchanging data publishes the restored result under outputID(), as its
+    // runWithArtifacts() would have. The default only restores.
+    virtual bool restoreWithArtifacts(std::string_view bytes, ArtifactStore& /*artifacts*/) {
+        return restoreResult(bytes);
+    }
+
     std::string statusString() const noexcept{
         switch (status) {
             case Status::Pending: return "Pending";
             case Status::Running: return "Running";
             case Status::Completed: return "Completed";
             case Status::Failed: return "Failed";
+            case Status::Skipped: return "Skipped";
             default: return "Pending";
         }
     }
@@ -64,6 +182,8 @@ public:
             status = Status::Completed;
         } else if (statusStr == "Failed") {
             status = Status::Failed;
+        } else if (statusStr == "Skipped") {
+            status = Status::Skipped;
         }
         else {
             throw std::invalid_argument("Invalid status string: " + statusStr);
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace eden {
+
+/**
+ * @brief Move-only void() callable with small-buffer storage
+ * @details Replacement for std::function<void()> on the executor hot path.
+ * Callables up to kInlineSize bytes (a lambda capturing a handful of references
+ * and an id, like the ones built by Workflow::run) are stored inline, so
+ * constructing, moving and destroying a Job does not touch the heap.
+ * Larger callables fall back to a heap allocation, counted by heapAllocations().
+ *
+ * Being move-only, a Job can also own move-only captures (unique_ptr, promise, ...).
+ */
+class Job {
+public:
+    static constexpr std::size_t kInlineSize = 48;
+
+    Job() noexcept = default;
+
+    template <class F>
+        requires (!std::same_as<std::remove_cvref_t<F>, Job> && std::invocable<std::remove_cvref_t<F>&>)
+    Job(F&& f) {  // NOLINT: implicit on purpose, lambdas convert like std::function
+        using Fn = std::remove_cvref_t<F>;
+        if constexpr (fitsInline<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &inlineOps<Fn>;
+        } else {
+            heapAllocations_.fetch_add(1, std::memory_order_relaxed);
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &heapOps<Fn>;
+        }
+    }
+
+    Job(Job&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    Job& operator=(Job&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                ops_ = other.ops_;
+                ops_->move(storage_, other.storage_);
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    ~Job() { reset(); }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    // Destroy the held callable (and its captures) now
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    // Number of Jobs, process-wide, whose callable did not fit the inline buffer
+    static std::uint64_t heapAllocations() noexcept {
+        return heapAllocations_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template <class Fn>
+    static constexpr bool fitsInline =
+        sizeof(Fn) <= kInlineSize &&
+        alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<Fn>;
+
+    template <class Fn>
+    static Fn* inlinePtr(void* p) noexcept { return std::launder(static_cast<Fn*>(p)); }
+
+    template <class Fn>
+    static Fn*& heapPtr(void* p) noexcept { return *std::launder(static_cast<Fn**>(p)); }
+
+    template <class Fn>
+    static constexpr Ops inlineOps {
+        [](void* self) { (*inlinePtr<Fn>(self))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*inlinePtr<Fn>(src)));
+            inlinePtr<Fn>(src)->~Fn();
+        },
+        [](void* self) noexcept { inlinePtr<Fn>(self)->~Fn(); }
+    };
+
+    template <class Fn>
+    static constexpr Ops heapOps {
+        [](void* self) { (*heapPtr<Fn>(self))(); },
+        [](void* dst, void* src) noexcept { ::new (dst) Fn*(heapPtr<Fn>(src)); },
+        [](void* self) noexcept { delete heapPtr<Fn>(self); }
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_ = nullptr;
+
+    static inline std::atomic<std::uint64_t> heapAllocations_{0};
+};
+
+} // namespace eden
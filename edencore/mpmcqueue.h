@@ -0,0 +1,113 @@
+#pragma once
+
+#include "hazardpointer.h"
+
+#include <atomic>
+
+namespace eden {
+
+/**
+ * @brief Intrusive lock-free MPMC FIFO queue (Michael & Scott, 1996)
+ * @details Unbounded multi-producer multi-consumer queue whose links live in
+ * the nodes themselves (member pointer `Next`), so pushing never allocates.
+ *
+ * The queue always holds one dummy node at the head. pop() advances the head:
+ * the node that carried the payload becomes the new dummy and the previous
+ * dummy is handed back to the caller, who must retire it through the
+ * HazardPointerDomain used by the queue's readers.
+ *
+ * Both operations take the caller's hazard slots, so reclamation stays under
+ * the owner's control (see ThreadPool for a user).
+ */
+template <class T, std::atomic<T*> T::*Next>
+class IntrusiveMpmcQueue {
+public:
+    struct PopResult {
+        // Carries the payload; still protected by the hpNext slot until the caller resets it
+        T* node = nullptr;
+        // Previous dummy, unlinked: retire it
+        T* retired = nullptr;
+    };
+
+    // Takes an initial dummy node
+    explicit IntrusiveMpmcQueue(T* dummy) {
+        (dummy->*Next).store(nullptr, std::memory_order_relaxed);
+        head_.store(dummy, std::memory_order_relaxed);
+        tail_.store(dummy, std::memory_order_relaxed);
+    }
+
+    IntrusiveMpmcQueue(const IntrusiveMpmcQueue&) = delete;
+    IntrusiveMpmcQueue& operator=(const IntrusiveMpmcQueue&) = delete;
+
+    // Append a single node
+    void push(T* node, HazardPointer& hp) {
+        (node->*Next).store(nullptr, std::memory_order_relaxed);
+        pushChain(node, node, hp);
+    }
+
+    // Append a chain already linked through Next, terminated at `last`, in one CAS
+    void pushChain(T* first, T* last, HazardPointer& hp) {
+        (last->*Next).store(nullptr, std::memory_order_relaxed);
+        while (true) {
+            T* tail = hp.protect(tail_);
+            T* next = (tail->*Next).load(std::memory_order_acquire);
+            if (tail != tail_.load(std::memory_order_acquire)) continue;
+
+            if (next) {
+                // Tail is lagging behind, help it forward
+                tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+
+            if ((tail->*Next).compare_exchange_weak(
+                    next, first, std::memory_order_release, std::memory_order_relaxed)) {
+                // Best effort: a failure means someone already helped
+                tail_.compare_exchange_strong(tail, last, std::memory_order_release, std::memory_order_relaxed);
+                break;
+            }
+        }
+        hp.reset();
+    }
+
+    // Remove the oldest element; result.node == nullptr when empty
+    PopResult pop(HazardPointer& hpHead, HazardPointer& hpNext) {
+        while (true) {
+            T* head = hpHead.protect(head_);
+            T* tail = tail_.load(std::memory_order_acquire);
+            T* next = hpNext.protect(head->*Next);
+            // `next` is only known safe if head is still the head
+            if (head != head_.load(std::memory_order_acquire)) continue;
+
+            if (!next) {
+                hpHead.reset();
+                hpNext.reset();
+                return {};
+            }
+
+            if (head == tail) {
+                // Never let head overtake a lagging tail
+                tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                hpHead.reset();
+                return {next, head};
+            }
+        }
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        T* head = head_.load(std::memory_order_acquire);
+        return (head->*Next).load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Single-threaded teardown only: the current dummy
+    [[nodiscard]] T* dummy() const noexcept { return head_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<T*> head_;
+    alignas(64) std::atomic<T*> tail_;
+};
+
+} // namespace eden
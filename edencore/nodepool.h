@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Recycling pool of intrusive list nodes
+ * @details Magazine-style free list: every owner thread (a pool worker) has its
+ * own cache, and a mutex-protected depot exchanges whole batches of nodes between
+ * caches. A node is only allocated with `new` when both its cache and the depot
+ * are empty, so once the pool has grown to the peak number of in-flight nodes,
+ * acquire/release perform no heap allocation at all.
+ *
+ * - Worker threads pass their cache index: acquire/release touch only that cache,
+ *   except for one depot lock per batch.
+ * - Other threads pass kNoCache and go straight to the depot.
+ *
+ * T must expose a `T* next` member, used as the free-list link while the node is idle.
+ * Nodes are default-constructed once and reused; callers reset their payload.
+ */
+template <class T>
+class NodePool {
+public:
+    static constexpr std::size_t kNoCache = std::numeric_limits<std::size_t>::max();
+
+    explicit NodePool(std::size_t caches, std::size_t batch = 64)
+      : caches_(caches), batch_(batch == 0 ? 1 : batch) {}
+
+    ~NodePool() {
+        for (auto& cache : caches_) {
+            freeList(cache.head);
+        }
+        freeList(depot_);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // Take a node from the given cache, refilling it from the depot if needed
+    T* acquire(std::size_t cache) {
+        if (cache == kNoCache) {
+            std::lock_guard lock(depotMutex_);
+            if (depot_) {
+                T* node = depot_;
+                depot_ = node->next;
+                --depotCount_;
+                return node;
+            }
+            return allocate();
+        }
+
+        Cache& c = caches_[cache];
+        if (!c.head) refill(c);
+        if (!c.head) return allocate();
+
+        T* node = c.head;
+        c.head = node->next;
+        --c.count;
+        return node;
+    }
+
+    // Give a node back; its payload must already be reset
+    void release(std::size_t cache, T* node) {
+        if (cache == kNoCache) {
+            std::lock_guard lock(depotMutex_);
+            node->next = depot_;
+            depot_ = node;
+            ++depotCount_;
+            return;
+        }
+
+        Cache& c = caches_[cache];
+        node->next = c.head;
+        c.head = node;
+        if (++c.count > 2 * batch_) spill(c);
+    }
+
+    // Number of nodes created with `new` since construction
+    [[nodiscard]] std::uint64_t allocations() const noexcept {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Cache {
+        T* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    T* allocate() {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        return new T();
+    }
+
+    // Move up to one batch from the depot into an empty cache
+    void refill(Cache& c) {
+        std::lock_guard lock(depotMutex_);
+        while (depot_ && c.count < batch_) {
+            T* node = depot_;
+            depot_ = node->next;
+            --depotCount_;
+            node->next = c.head;
+            c.head = node;
+            ++c.count;
+        }
+    }
+
+    // Hand one batch back to the depot so other threads can reuse it
+    void spill(Cache& c) {
+        std::lock_guard lock(depotMutex_);
+        for (std::size_t i = 0; i < batch_ && c.head; ++i) {
+            T* node = c.head;
+            c.head = node->next;
+            --c.count;
+            node->next = depot_;
+            depot_ = node;
+            ++depotCount_;
+        }
+    }
+
+    static void freeList(T* head) {
+        while (head) {
+            T* next = head->next;
+            delete head;
+            head = next;
+        }
+    }
+
+    std::vector<Cache> caches_;
+    std::size_t batch_;
+
+    std::mutex depotMutex_;
+    T* depot_ = nullptr;
+    std::size_t depotCount_ = 0;
+
+    std::atomic<std::uint64_t> allocations_{0};
+};
+
+} // namespace eden
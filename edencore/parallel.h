@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace eden {
+
+/**
+ * @brief Data-parallel loops over any IThreadExecutor
+ * @details The range is cut into chunks of `grain` elements. Chunks are handed out
+ * through a shared atomic counter to up to executor.concurrency() helper jobs
+ * and to the calling thread, which works too instead of blocking. The call
+ * returns once every chunk has run.
+ *
+ * Because the caller takes chunks itself, it never waits for a helper that has
+ * not started yet. Calling these from inside a pool job (nested parallelism)
+ * cannot deadlock, even when every worker is busy.
+ *
+ * grain == kAutoGrain picks about four chunks per thread. That is enough to
+ * balance uneven iterations without paying for too many atomic claims.
+ *
+ * The first exception thrown by the body stops further chunks from starting.
+ * It is rethrown in the caller once the chunks already running have finished.
+ */
+inline constexpr std::size_t kAutoGrain = 0;
+
+namespace detail {
+
+struct ChunkState {
+    std::size_t total = 0;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::atomic<bool> failed{false};
+    // Written once, by the chunk that sets failed
+    std::exception_ptr error;
+};
+
+inline std::size_t chunkSize(const IThreadExecutor& executor, std::size_t n, std::size_t grain) {
+    if (grain != kAutoGrain) return grain;
+    const std::size_t chunks = 4 * (executor.concurrency() + 1);
+    return std::max<std::size_t>(1, (n + chunks - 1) / chunks);
+}
+
+// Claim and run chunks until none are left
+template <class ChunkFn>
+void drainChunks(ChunkState& state, ChunkFn& fn) {
+    while (true) {
+        const std::size_t chunk = state.next.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= state.total) return;
+
+        if (!state.failed.load(std::memory_order_relaxed)) {
+            try {
+                fn(chunk);
+            } catch (...) {
+                if (!state.failed.exchange(true, std::memory_order_relaxed)) {
+                    state.error = std::current_exception();
+                }
+            }
+        }
+        if (state.done.fetch_add(1, std::memory_order_acq_rel) + 1 == state.total) {
+            state.done.notify_all();
+        }
+    }
+}
+
+// Run fn(chunk) for chunk in [0, chunks) on the executor and the calling thread
+template <class ChunkFn>
+void runChunks(IThreadExecutor& executor, std::size_t chunks, ChunkFn&& fn) {
+    if (chunks == 0) return;
+    if (chunks == 1) {
+        fn(std::size_t{0});
+        return;
+    }
+
+    // Shared with the helpers: one that starts after the loop is over only touches the state
+    auto state = std::make_shared<ChunkState>();
+    state->total = chunks;
+
+    const std::size_t helpers = std::min(chunks - 1, executor.concurrency());
+    if (helpers > 0) {
+        std::vector<Job> jobs;
+        jobs.reserve(helpers);
+        for (std::size_t i = 0; i < helpers; ++i) {
+            // fn is only called for a claimed chunk, while the caller is still waiting below
+            jobs.emplace_back([state, &fn] { drainChunks(*state, fn); });
+        }
+        executor.enqueueBulk(jobs);
+    }
+
+    drainChunks(*state, fn);
+
+    std::size_t done = state->done.load(std::memory_order_acquire);
+    while (done < chunks) {
+        state->done.wait(done, std::memory_order_acquire);
+        done = state->done.load(std::memory_order_acquire);
+    }
+
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace detail
+
+/// body(i) for every i in [first, last)
+template <class Index, class Body>
+    requires std::is_integral_v<Index>
+void parallel_for(IThreadExecutor& executor, Index first, Index last, Body&& body, std::size_t grain = kAutoGrain) {
+    if (last <= first) return;
+    const auto n = static_cast<std::size_t>(last - first);
+    const std::size_t size = detail::chunkSize(executor, n, grain);
+
+    detail::runChunks(executor, (n + size - 1) / size, [&](std::size_t chunk) {
+        const Index begin = first + static_cast<Index>(chunk * size);
+        const Index end = static_cast<Index>(std::min(n, (chunk + 1) * size)) + first;
+        for (Index i = begin; i < end; ++i) body(i);
+    });
+}
+
+/**
+ * reduce(identity, map(first), ..., map(last - 1)), reduce being associative.
+ * Every chunk is folded separately, then the chunk results are combined in index
+ * order: for a given grain the result does not depend on the scheduling, which
+ * keeps floating-point sums reproducible from one run to the next.
+ */
+template <class Index, class T, class Map, class Reduce>
+    requires std::is_integral_v<Index>
+T parallel_reduce(IThreadExecutor& executor, Index first, Index last, T identity,
+                  Map&& map, Reduce&& reduce, std::size_t grain = kAutoGrain) {
+    if (last <= first) return identity;
+    const auto n = static_cast<std::size_t>(last - first);
+    const std::size_t size = detail::chunkSize(executor, n, grain);
+    const std::size_t chunks = (n + size - 1) / size;
+
+    std::vector<T> partials(chunks, identity);
+    detail::runChunks(executor, chunks, [&](std::size_t chunk) {
+        const Index begin = first + static_cast<Index>(chunk * size);
+        const Index end = static_cast<Index>(std::min(n, (chunk + 1) * size)) + first;
+        T acc = identity;
+        for (Index i = begin; i < end; ++i) acc = reduce(std::move(acc), map(i));
+        partials[chunk] = std::move(acc);
+    });
+
+    T result = std::move(identity);
+    for (auto& partial : partials) result = reduce(std::move(result), std::move(partial));
+    return result;
+}
+
+/// *(out + k) = op(*(first + k)) for every element, like std::transform
+template <std::random_access_iterator InputIt, std::random_access_iterator OutputIt, class UnaryOp>
+OutputIt parallel_transform(IThreadExecutor& executor, InputIt first, InputIt last, OutputIt out,
+                            UnaryOp&& op, std::size_t grain = kAutoGrain) {
+    const auto n = static_cast<std::size_t>(std::distance(first, last));
+    parallel_for(executor, std::size_t{0}, n, [&](std::size_t k) {
+        const auto offset = static_cast<std::iter_difference_t<InputIt>>(k);
+        out[static_cast<std::iter_difference_t<OutputIt>>(k)] = op(first[offset]);
+    }, grain);
+    return out + static_cast<std::iter_difference_t<OutputIt>>(n);
+}
+
+} // namespace eden
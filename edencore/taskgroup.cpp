@@ -0,0 +1,46 @@
+#include "taskgroup.h"
+
+#include <thread>
+
+namespace eden {
+
+namespace {
+
+constexpr int kYieldIterations = 16;
+
+} // namespace
+
+void TaskGroup::join() noexcept {
+    int idle = 0;
+    while (true) {
+        const std::uint64_t state = state_.load(std::memory_order_acquire);
+        if ((state & kPendingMask) == 0) return;
+
+        // Run whatever is queued, ours or not: our jobs may sit behind it
+        if (executor_.tryRunPendingJob()) {
+            idle = 0;
+            continue;
+        }
+
+        // Nothing queued, the rest of the group is running elsewhere
+        if (idle < kYieldIterations) {
+            ++idle;
+            std::this_thread::yield();
+            continue;
+        }
+        // Woken by any job of the group starting or finishing
+        state_.wait(state, std::memory_order_acquire);
+        idle = 0;
+    }
+}
+
+void TaskGroup::wait() {
+    join();
+    if (failed_.exchange(false, std::memory_order_acquire)) {
+        std::exception_ptr error = std::move(error_);
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace eden
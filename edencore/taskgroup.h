@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency.h"
+#include "threadpool.h"
+
+namespace eden {
+
+/**
+ * @brief Fork-join scope over an IThreadExecutor
+ * @details run() enqueues a job that belongs to the group; wait() returns once
+ * every job of the group has finished, including the ones the jobs themselves
+ * added while running. Waiting does not block a thread: the caller takes queued
+ * jobs off the executor (IThreadExecutor::tryRunPendingJob) and only parks once
+ * there is nothing left to run. A pool job can therefore open a group and wait on
+ * it, at any nesting depth, without starving the pool even with a single worker.
+ *
+ * The first exception thrown by a job is kept and rethrown by wait(), once the
+ * other jobs of the group are done.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(IThreadExecutor& executor) noexcept : executor_(executor) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Jobs still referencing the group must finish first; exceptions are dropped here
+    ~TaskGroup() { join(); }
+
+    /// Enqueue f as a job of the group
+    template <class F>
+    void run(F&& f, JobPriority priority = JobPriority::Normal) {
+        executor_.enqueue(wrap(std::forward<F>(f)), priority);
+    }
+
+    /**
+     * Job running f on behalf of the group, for callers that submit it themselves
+     * (enqueueBulk, another executor). The group counts it from this call on:
+     * it must be run, or wait() never returns.
+     */
+    template <class F>
+    [[nodiscard]] Job wrap(F&& f) {
+        state_.fetch_add(kEpoch + 1, std::memory_order_relaxed);
+        return [this, fn = std::forward<F>(f)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                if (!failed_.exchange(true, std::memory_order_relaxed)) error_ = std::current_exception();
+            }
+            finish();
+        };
+    }
+
+    /// Help run queued jobs until the group is done, then rethrow the first failure
+    void wait();
+
+    /// Jobs of the group not finished yet
+    [[nodiscard]] std::uint32_t pending() const noexcept {
+        return static_cast<std::uint32_t>(state_.load(std::memory_order_acquire) & kPendingMask);
+    }
+
+private:
+    // state_ packs the pending count (low half) and an epoch (high half) bumped by every
+    // start and finish, so a parked waiter wakes on any change and never misses one
+    // (pending can return to the same value, the word cannot).
+    static constexpr std::uint64_t kEpoch = std::uint64_t{1} << 32;
+    static constexpr std::uint64_t kPendingMask = kEpoch - 1;
+
+    void finish() noexcept {
+        // One atomic step: the waiter may destroy the group as soon as it sees 0,
+        // after that only the address is used to wake it
+        state_.fetch_add(kEpoch - 1, std::memory_order_acq_rel);
+        state_.notify_all();
+    }
+
+    void join() noexcept;
+
+    IThreadExecutor& executor_;
+    std::atomic<std::uint64_t> state_{0};
+    std::atomic<bool> failed_{false};
+    // Written once, by the job that sets failed_
+    std::exception_ptr error_;
+};
+
+} // namespace eden
@@ -1,100 +1,707 @@
+
 #include "threadpool.h"
+#include "timerwheel.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
 
 namespace eden {
 
+namespace {
+
+// Identifies the pool and worker index of the current thread, if it is a pool worker.
+// Lets enqueue() from inside a job target the calling worker's local deque and
+// reuse its hazard slot (idle while the job runs).
+struct WorkerSlot {
+    const ThreadPool* pool = nullptr;
+    std::size_t index = 0;
+    HazardPointer* hazard = nullptr;
+    HazardPointer* hazardNext = nullptr;
+    int numaNode = -1;
+};
+
+thread_local WorkerSlot tlsWorker;
+
+// Adaptive wait tuning: ~a few microseconds of spinning, then a few yields, then park
+constexpr int kSpinIterations = 128;
+constexpr int kYieldIterations = 16;
+
+// Polling interval of an idle surplus worker (elastic pool), doubling up to the maximum
+constexpr auto kMinPollInterval = std::chrono::microseconds(50);
+constexpr auto kMaxPollInterval = std::chrono::microseconds(1000);
+
+// Tell the CPU we are in a spin loop (frees pipeline resources for the SMT sibling)
+inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Timestamps for the statistics (vDSO call on Linux, no syscall)
+inline std::uint64_t nowNs() noexcept {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Queue wait is sampled: one job in kWaitSampleRate per producer thread carries a timestamp
+constexpr std::uint32_t kWaitSampleRate = 16;
+
+inline std::uint64_t sampledEnqueueTime() noexcept {
+    thread_local std::uint32_t count = 0;
+    return ++count % kWaitSampleRate == 0 ? nowNs() : 0;
+}
+
+// Single-writer counter update: cheaper than fetch_add, no lock prefix
+inline void addTo(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Cheap per-thread xorshift generator to spread steal attempts across victims
+std::size_t nextVictimSeed() noexcept {
+    thread_local std::uint64_t state =
+        0x9E3779B97F4A7C15ull ^ std::hash<std::thread::id>{}(std::this_thread::get_id());
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<std::size_t>(state);
+}
+
+} // namespace
+
+TopologyProvider::TopologyProvider(CpuTopology topology, PinningPolicy policy, bool excludeSmtSiblings)
+  : topology_(std::move(topology)), policy_(policy) {
+    for (const auto& cpu : topology_.cpus()) {
+        if (excludeSmtSiblings && cpu.smtRank > 0) continue;
+        order_.push_back(cpu);
+    }
+    // Socket by socket, first hardware thread of every core before the siblings
+    std::stable_sort(order_.begin(), order_.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+        if (a.package != b.package) return a.package < b.package;
+        if (a.smtRank != b.smtRank) return a.smtRank < b.smtRank;
+        return a.core < b.core;
+    });
+    if (order_.empty()) order_ = topology_.cpus();
+}
+
+WorkerPlacement TopologyProvider::placementFor(std::size_t worker) const {
+    // More workers than CPUs wrap around
+    const LogicalCpu& cpu = order_[worker % order_.size()];
+    WorkerPlacement placement;
+    placement.numaNode = static_cast<int>(cpu.numaNode);
+
+    switch (policy_) {
+        case PinningPolicy::None:
+            break;
+        case PinningPolicy::Core:
+            placement.cpus.push_back(cpu.id);
+            break;
+        case PinningPolicy::Socket:
+            for (const auto& other : order_) {
+                if (other.package != cpu.package) continue;
+                placement.cpus.push_back(other.id);
+                // A socket split in several NUMA nodes (sub-NUMA clustering) has no single node
+                if (other.numaNode != cpu.numaNode) placement.numaNode = -1;
+            }
+            break;
+    }
+    return placement;
+}
+
 // Initialize the thread pool with worker threads
-ThreadPool::ThreadPool(std::size_t nThreads) {
-    workers_.reserve(nThreads);
-    for (std::size_t i = 0; i < nThreads; ++i) {
-        // std::jthread will capture a stop_token for us
-        workers_.emplace_back([this](std::stop_token st) {
-            this->workerLoop(st);
-        });
+ThreadPool::ThreadPool(std::size_t nThreads, SchedulingMode mode)
+  : ThreadPool(ElasticLimits{nThreads, nThreads}, mode, {}, false) {}
+
+ThreadPool::ThreadPool(const IThreadPlacementProvider& prov, SchedulingMode mode)
+  : ThreadPool(ElasticLimits{prov.getThreadCount(), prov.getThreadCount()}, mode, [&prov] {
+        std::vector<WorkerPlacement> placements;
+        for (std::size_t i = 0; i < prov.getThreadCount(); ++i) {
+            placements.push_back(prov.placementFor(i));
+        }
+        return placements;
+    }(), false) {}
+
+ThreadPool::ThreadPool(const ElasticLimits& limits, SchedulingMode mode)
+  : ThreadPool([&limits] {
+        if (limits.minWorkers == 0 || limits.maxWorkers < limits.minWorkers) {
+            throw std::invalid_argument("ThreadPool: elastic limits need 1 <= minWorkers <= maxWorkers");
+        }
+        return limits;
+    }(), mode, {}, true) {}
+
+// Every slot an elastic pool may use is allocated up front (deques, counters, node caches):
+// starting or retiring a worker never resizes anything another thread reads.
+ThreadPool::ThreadPool(const ElasticLimits& limits, SchedulingMode mode, std::vector<WorkerPlacement> placements,
+                       bool elastic)
+  : mode_(mode), nodes_(limits.maxWorkers),
+    counters_(std::make_unique<WorkerCounters[]>(limits.maxWorkers)),
+    placements_(std::move(placements)),
+    elastic_(elastic), limits_(limits),
+    running_(std::make_unique<std::atomic<bool>[]>(limits.maxWorkers)) {
+    const std::size_t nThreads = limits.maxWorkers;
+    if (mode_ == SchedulingMode::WorkStealing) {
+        locals_.reserve(nThreads);
+        for (std::size_t i = 0; i < nThreads; ++i) {
+            locals_.push_back(std::make_unique<WorkStealingDeque<Node*>>());
+        }
+    } else if (mode_ == SchedulingMode::Priority) {
+        for (auto& lane : lanes_) {
+            // Each lane starts with its own dummy node
+            lane = std::make_unique<LaneQueue>(nodes_.acquire(NodePool<Node>::kNoCache));
+        }
+    }
+
+    workers_.resize(nThreads);
+    for (std::size_t i = 0; i < limits_.minWorkers; ++i) {
+        startWorker(i);
+    }
+}
+
+void ThreadPool::startWorker(std::size_t index) {
+    running_[index].store(true, std::memory_order_relaxed);
+    active_.fetch_add(1, std::memory_order_relaxed);
+    // std::jthread will capture a stop_token for us
+    workers_[index] = std::jthread([this, index](std::stop_token st) {
+        this->workerLoop(st, index);
+        active_.fetch_sub(1, std::memory_order_relaxed);
+        running_[index].store(false, std::memory_order_release);
+    });
+}
+
+/*
+Elastic growth:
+A worker that starts a job which waited longer than spawnAfterWait asks for one more
+worker. Requests are throttled to one per spawnAfterWait by a CAS on lastSpawnNs_, so
+a backlog ramps the pool up gradually instead of jumping straight to maxWorkers.
+The new worker takes the first free slot above minWorkers; a slot whose worker retired
+still holds its finished thread, joined here before the slot is reused.
+*/
+void ThreadPool::grow(std::uint64_t now) {
+    if (active_.load(std::memory_order_relaxed) >= limits_.maxWorkers) return;
+
+    const auto interval = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(limits_.spawnAfterWait).count());
+    std::uint64_t last = lastSpawnNs_.load(std::memory_order_relaxed);
+    if (now - last < interval) return;
+    if (!lastSpawnNs_.compare_exchange_strong(last, now, std::memory_order_relaxed)) return;
+
+    std::lock_guard lock(growMutex_);
+    if (stopping_) return;
+    for (std::size_t i = limits_.minWorkers; i < limits_.maxWorkers; ++i) {
+        if (running_[i].load(std::memory_order_acquire)) continue;
+        if (workers_[i].joinable()) workers_[i].join();
+        startWorker(i);
+        return;
     }
 }
 
 // Gracefully shut down the thread pool
 ThreadPool::~ThreadPool() {
-    // Unblock any workers still waiting
-    // Release semaphore to unblock threads
     std::cout << "ThreadPool shutting down...\n";
-    for (std::size_t i = 0; i < workers_.size(); ++i) {
-        sem_.release();
+    // The timer thread enqueues into the pool: stop it while the workers still run.
+    // Jobs still running may try to arm timers meanwhile: they find the wheel closed.
+    std::unique_ptr<TimerWheel> timers;
+    {
+        std::lock_guard lock(timersMutex_);
+        timersClosed_ = true;
+        timers = std::move(timers_);
+    }
+    timers.reset();
+    {
+        // No elastic spawn after this point
+        std::lock_guard lock(growMutex_);
+        stopping_ = true;
+        // Each worker's stop callback wakes the parked workers immediately
+        for (auto& worker : workers_) {
+            worker.request_stop();
+        }
+    }
+    // ~std::jthread joins
+    workers_.clear();
+
+    // Drop jobs that were never picked up; nodes_ frees the memory
+    HazardPointer hp(hazards_);
+    while (Node* node = popShared(hp)) {
+        node->job.reset();
+        nodes_.release(NodePool<Node>::kNoCache, node);
+    }
+    for (auto& local : locals_) {
+        while (auto node = local->steal()) {
+            (*node)->job.reset();
+            nodes_.release(NodePool<Node>::kNoCache, *node);
+        }
+    }
+    if (mode_ == SchedulingMode::Priority) {
+        HazardPointer hpNext(hazards_);
+        while (popLanes(hp, hpNext).job) {}
+        for (auto& lane : lanes_) {
+            nodes_.release(NodePool<Node>::kNoCache, lane->dummy());
+        }
     }
-    // ~std::jthread will request_stop() and then join()
 }
 
-// A lock-free stack is a data structure that allows multiple threads 
-// to push and pop items without blocking each other using mutexes. 
+// A lock-free stack is a data structure that allows multiple threads
+// to push and pop items without blocking each other using mutexes.
 // It relies on atomic operations like compare_exchange_weak to safely manage shared state.
 
 /*
 Enqueue a job:
-A new Node is allocated to hold the job.
+A Node is taken from the pool (the caller's worker cache, or the shared depot) to hold the job.
+In Priority mode it is appended to the lane of its priority (see pushLane).
+In WorkStealing mode, a job enqueued from one of our own workers goes to that worker's deque.
+Otherwise we push it on the shared stack (see pushShared).
+*/
+void ThreadPool::enqueue(Job job) {
+    enqueue(std::move(job), JobPriority::Normal);
+}
+
+void ThreadPool::enqueue(Job job, JobPriority priority) {
+    const bool fromWorker = tlsWorker.pool == this;
+
+    // Recycle a job node, no allocation in steady state
+    Node* node = nodes_.acquire(fromWorker ? tlsWorker.index : NodePool<Node>::kNoCache);
+    node->job = std::move(job);
+    node->enqueuedAt = elastic_ ? nowNs() : sampledEnqueueTime();
+
+    if (mode_ == SchedulingMode::Priority) {
+        pushLane(node, priority);
+    } else if (mode_ == SchedulingMode::WorkStealing && fromWorker) {
+        // Owner push, no CAS and no shared cache line
+        node->shared = false;
+        locals_[tlsWorker.index]->push(node);
+    } else {
+        pushShared(node);
+    }
+
+    // Notify one thread
+    notifyJobs(1);
+}
+
+/*
+Bulk enqueue:
+The nodes are linked into one chain before anything is published, then the chain goes
+to the shared stack or to a priority lane with a single CAS, and one notifyJobs(n) wakes
+the parked workers with a single futex call instead of n.
+Jobs enqueued from a worker in WorkStealing mode go to its own deque (no CAS at all).
+*/
+void ThreadPool::enqueueBulk(std::span<Job> jobs, JobPriority priority) {
+    if (jobs.empty()) return;
+
+    const bool fromWorker = tlsWorker.pool == this;
+    const std::size_t cache = fromWorker ? tlsWorker.index : NodePool<Node>::kNoCache;
+    // One clock read for the whole batch
+    const std::uint64_t now = nowNs();
+
+    if (mode_ == SchedulingMode::WorkStealing && fromWorker) {
+        for (Job& job : jobs) {
+            Node* node = nodes_.acquire(cache);
+            node->job = std::move(job);
+            node->enqueuedAt = now;
+            node->shared = false;
+            locals_[tlsWorker.index]->push(node);
+        }
+    } else {
+        Node* first = nullptr;
+        Node* last = nullptr;
+        for (Job& job : jobs) {
+            Node* node = nodes_.acquire(cache);
+            node->job = std::move(job);
+            node->enqueuedAt = now;
+            if (mode_ == SchedulingMode::Priority) {
+                node->laneNext.store(nullptr, std::memory_order_relaxed);
+                if (last) last->laneNext.store(node, std::memory_order_relaxed);
+            } else {
+                node->next = nullptr;
+                if (last) last->next = node;
+            }
+            if (!first) first = node;
+            last = node;
+        }
+
+        if (mode_ == SchedulingMode::Priority) {
+            pushLaneChain(first, last, priority);
+        } else {
+            pushSharedChain(first, last);
+        }
+    }
+
+    notifyJobs(static_cast<std::int64_t>(jobs.size()));
+}
+
+/*
+Waking protocol (no lost wake-ups):
+- enqueue:  pending_++ then read sleepers_
+- park:     sleepers_++ then read wakeEpoch_ then re-check pending_ then wait(epoch)
+All four are seq_cst, so either the parker sees the new job, or the enqueuer sees the
+parker and bumps wakeEpoch_, which makes wait() return even if it has not started yet.
+*/
+void ThreadPool::notifyJobs(std::int64_t count) {
+    pending_.fetch_add(count, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (count == 1) {
+            wakeEpoch_.notify_one();
+        } else {
+            wakeEpoch_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::wakeAll() noexcept {
+    wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    wakeEpoch_.notify_all();
+}
+
+bool ThreadPool::tryClaim() noexcept {
+    std::int64_t n = pending_.load(std::memory_order_seq_cst);
+    while (n > 0) {
+        if (pending_.compare_exchange_weak(n, n - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::waitForJob(const std::stop_token& st, bool surplus) {
+    // 1) Spin: a dependent job is often enqueued within a few hundred nanoseconds
+    for (int i = 0; i < kSpinIterations; ++i) {
+        if (tryClaim()) return true;
+        cpuRelax();
+    }
+
+    // 2) Yield: give the producer a chance to run if it shares our core
+    for (int i = 0; i < kYieldIterations; ++i) {
+        if (tryClaim()) return true;
+        if (st.stop_requested()) return false;
+        std::this_thread::yield();
+    }
+
+    // 3a) Surplus worker: poll with a growing interval, retire once idle for long enough.
+    // It is not counted in sleepers_: enqueues wake the permanent workers first.
+    if (surplus) {
+        const auto idleSince = std::chrono::steady_clock::now();
+        auto interval = kMinPollInterval;
+        while (true) {
+            if (tryClaim()) return true;
+            if (st.stop_requested()) return false;
+            if (std::chrono::steady_clock::now() - idleSince >= limits_.retireAfterIdle) return false;
+            std::this_thread::sleep_for(interval);
+            interval = std::min(interval * 2, kMaxPollInterval);
+        }
+    }
+
+    // 3) Park on the futex until an enqueue or a stop request bumps the epoch
+    while (true) {
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        const auto epoch = wakeEpoch_.load(std::memory_order_seq_cst);
+        if (tryClaim()) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (st.stop_requested()) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        wakeEpoch_.wait(epoch, std::memory_order_seq_cst);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (tryClaim()) return true;
+        if (st.stop_requested()) return false;
+    }
+}
+
+/*
 We read the current head_ (top of the stack).
 We try to atomically replace head_ with our new node, setting its next pointer to the old head_.
 This repeats until the replacement succeeds — another thread might be pushing/popping at the same time.
 This is called a CAS loop (Compare-And-Swap loop).
 */
-void ThreadPool::enqueue(std::function<void()> job) {
-    // Create a new job node
-    Node* node = new Node{std::move(job), nullptr};
-    // Lock-free push to the stack
+void ThreadPool::pushShared(Node* node) {
+    pushSharedChain(node, node);
+}
+
+// Same CAS loop for a chain: only the last node's link changes between attempts
+void ThreadPool::pushSharedChain(Node* first, Node* last) {
+    for (Node* node = first; node != last; node = node->next) {
+        node->shared = true;
+    }
+    last->shared = true;
+
     Node* old = head_.load(std::memory_order_relaxed);
     do {
-        node->next = old;
+        last->next = old;
     } while (!head_.compare_exchange_weak(
-        old, node,
-        // std::memory_order_release — ensures we publish the node to other threads safely.
+        old, first,
+        // std::memory_order_release — ensures we publish the nodes to other threads safely.
         std::memory_order_release,
         std::memory_order_relaxed));
-
-    // Notify one thread
-    sem_.release();
 }
 
-// Worker thread logic
 /*
-Load the top of the stack.
+Load the top of the stack and publish it in our hazard slot.
 If it's not nullptr, try to replace it with the next node in the chain.
 Once successful, we return that node and execute its job.
 If another thread pops first, we retry.
+
+Reading node->next is only safe because the node is protected: another thread may
+pop and finish it meanwhile, but it is retired rather than recycled (see recycle),
+so it can neither be reused (use-after-free) nor come back to the head (ABA).
 */
-void ThreadPool::workerLoop(std::stop_token st) {
+ThreadPool::Node* ThreadPool::popShared(HazardPointer& hp) {
     while (true) {
-        // Try to acquire work, with a timeout
-        while (!sem_.try_acquire_for(std::chrono::milliseconds(50))) {
-            if (st.stop_requested()) return;
-        }
-
-        // Try to pop a job from the stack
-
-        // Load the top of the stack.
-        // If it's not nullptr, try to replace it with the next node in the chain.
-        // Once successful, we return that node and execute its job.
-        // If another thread pops first, we retry.
-        Node* node = nullptr;
-        do {
-            // std::memory_order_acquire — ensures we read data safely after loading the pointer.
-            node = head_.load(std::memory_order_acquire);
-            if (!node) break;
-        } while (!head_.compare_exchange_weak(
-            node, node->next,
-            // acq_rel (acquire + release) is used on the CAS to enforce both rules.
-            std::memory_order_acq_rel,
-            std::memory_order_acquire));
+        Node* node = hp.protect(head_);
+        if (!node) break;
+
+        Node* next = node->next;
+        if (head_.compare_exchange_weak(
+                node, next,
+                // acq_rel (acquire + release) is used on the CAS to enforce both rules.
+                std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+            hp.reset();
+            return node;
+        }
+    }
+    hp.reset();
+    return nullptr;
+}
+
+/*
+Priority lanes are Michael-Scott queues: producers append at the tail, consumers
+take from the head, so jobs of one level run in submission order.
+Appending reads the tail node, hence the hazard slot: workers reuse theirs,
+other threads borrow one for the duration of the push.
+*/
+void ThreadPool::pushLane(Node* node, JobPriority priority) {
+    node->laneNext.store(nullptr, std::memory_order_relaxed);
+    pushLaneChain(node, node, priority);
+}
+
+void ThreadPool::pushLaneChain(Node* first, Node* last, JobPriority priority) {
+    LaneQueue& lane = *lanes_[static_cast<std::size_t>(priority)];
+    if (tlsWorker.pool == this) {
+        lane.pushChain(first, last, *tlsWorker.hazard);
+    } else {
+        HazardPointer hp(hazards_);
+        lane.pushChain(first, last, hp);
+    }
+}
+
+ThreadPool::Claim ThreadPool::popLanes(HazardPointer& hp, HazardPointer& hpNext) {
+    for (std::size_t level = kJobPriorityCount; level-- > 0;) {
+        auto [node, retired] = lanes_[level]->pop(hp, hpNext);
+        if (!node) continue;
+
+        // The node stays in the lane as its new dummy, only the job leaves
+        Claim claim{std::move(node->job), node->enqueuedAt};
+        hpNext.reset();
+        // The old dummy may still be read by a concurrent push or pop
+        hazards_.retire(retired, &ThreadPool::reclaimNode, this);
+        return claim;
+    }
+    return {};
+}
+
+ThreadPool::Claim ThreadPool::takeJob(Node* node, std::size_t cache) {
+    Claim claim{std::move(node->job), node->enqueuedAt};
+    recycle(node, cache);
+    return claim;
+}
+
+void ThreadPool::recycle(Node* node, std::size_t cache) {
+    // The job has been moved out already (takeJob), the node is empty
+    if (node->shared) {
+        // Another pop may still hold it as a hazard
+        hazards_.retire(node, &ThreadPool::reclaimNode, this);
+    } else {
+        // Deque values are copied out, nobody else dereferences the node
+        nodes_.release(cache, node);
+    }
+}
+
+void ThreadPool::reclaimNode(HazardPointerObject* obj, void* ctx) {
+    auto* pool = static_cast<ThreadPool*>(ctx);
+    auto* node = static_cast<Node*>(obj);
+    pool->nodes_.release(tlsWorker.pool == pool ? tlsWorker.index : NodePool<Node>::kNoCache, node);
+}
+
+ThreadPool::Node* ThreadPool::steal(std::size_t thief) {
+    const std::size_t n = locals_.size();
+    const std::size_t start = nextVictimSeed() % n;
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::size_t victim = (start + k) % n;
+        if (victim == thief) continue;
+        if (auto node = locals_[victim]->steal()) return *node;
+    }
+    return nullptr;
+}
+
+// Each token in pending_ stands for exactly one published job, so a thread holding
+// a token is guaranteed to find one eventually; a steal may fail spuriously under
+// contention, hence the retry loop.
+ThreadPool::Claim ThreadPool::findJob(std::size_t index, HazardPointer& hp, HazardPointer& hpNext, const std::stop_token& st) {
+    while (true) {
+        if (mode_ == SchedulingMode::Priority) {
+            if (Claim claim = popLanes(hp, hpNext); claim.job) return claim;
+        } else {
+            if (mode_ == SchedulingMode::WorkStealing && index != NodePool<Node>::kNoCache) {
+                if (auto node = locals_[index]->pop()) return takeJob(*node, index);
+            }
+            if (Node* node = popShared(hp)) return takeJob(node, index);
+            if (mode_ == SchedulingMode::WorkStealing) {
+                if (Node* node = steal(index)) {
+                    if (index != NodePool<Node>::kNoCache) addTo(counters_[index].steals, 1);
+                    return takeJob(node, index);
+                }
+            }
+        }
+        // Give up on shutdown; the destructor drains what is left
+        if (st.stop_requested()) return {};
+        std::this_thread::yield();
+    }
+}
+
+ExecutorStats ThreadPool::stats() const {
+    ExecutorStats stats;
+    stats.queued = std::max<std::int64_t>(0, pending_.load(std::memory_order_relaxed));
+    stats.workers.resize(limits_.maxWorkers);
+    for (std::size_t i = 0; i < stats.workers.size(); ++i) {
+        const WorkerCounters& c = counters_[i];
+        WorkerStats& w = stats.workers[i];
+        w.jobs = c.jobs.load(std::memory_order_relaxed);
+        w.steals = c.steals.load(std::memory_order_relaxed);
+        w.exceptions = c.exceptions.load(std::memory_order_relaxed);
+        w.busy = std::chrono::nanoseconds(c.busyNs.load(std::memory_order_relaxed));
+        w.idle = std::chrono::nanoseconds(c.idleNs.load(std::memory_order_relaxed));
+        w.localQueue = locals_.empty() ? 0 : locals_[i]->size();
+        for (std::size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            w.queueWait.counts[b] = c.queueWait[b].load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+void ThreadPool::runJob(Job& job, WorkerCounters* counters) noexcept {
+    try {
+        job();
+    } catch (...) {
+        // Handle or log the exception
+        if (counters) addTo(counters->exceptions, 1);
+        std::cerr << "Exception in worker thread\n";
+    }
+    if (counters) addTo(counters->jobs, 1);
+}
+
+/*
+Help-while-waiting:
+A thread blocked on sub-jobs (TaskGroup::wait, Workflow::run) runs queued jobs instead of
+sleeping. It claims a token exactly like a worker, so the job count stays balanced, and
+then searches with its own hazard slots; a caller outside the pool borrows two.
+The token guarantees a job is there, so findJob cannot come back empty (no stop token).
+*/
+bool ThreadPool::tryRunPendingJob() {
+    if (!tryClaim()) return false;
+
+    if (tlsWorker.pool == this) {
+        const std::size_t index = tlsWorker.index;
+        Claim claim = findJob(index, *tlsWorker.hazard, *tlsWorker.hazardNext, std::stop_token{});
+        runJob(claim.job, &counters_[index]);
+    } else {
+        Claim claim;
+        {
+            HazardPointer hp(hazards_);
+            HazardPointer hpNext(hazards_);
+            claim = findJob(NodePool<Node>::kNoCache, hp, hpNext, std::stop_token{});
+        }
+        runJob(claim.job, nullptr);
+    }
+    return true;
+}
+
+TimerWheel* ThreadPool::timers() {
+    if (!timers_ && !timersClosed_) timers_ = std::make_unique<TimerWheel>(*this);
+    return timers_.get();
+}
+
+TimerId ThreadPool::enqueueAfter(std::chrono::nanoseconds delay, Job job) {
+    std::lock_guard lock(timersMutex_);
+    TimerWheel* wheel = timers();
+    return wheel ? wheel->after(delay, std::move(job)) : 0;
+}
+
+TimerId ThreadPool::enqueueEvery(std::chrono::nanoseconds period, Job job) {
+    std::lock_guard lock(timersMutex_);
+    TimerWheel* wheel = timers();
+    return wheel ? wheel->every(period, std::move(job)) : 0;
+}
+
+bool ThreadPool::cancelTimer(TimerId id) {
+    std::lock_guard lock(timersMutex_);
+    return timers_ && timers_->cancel(id);
+}
+
+int ThreadPool::currentNumaNode() noexcept {
+    return tlsWorker.pool ? tlsWorker.numaNode : -1;
+}
+
+// Worker thread logic
+void ThreadPool::workerLoop(std::stop_token st, std::size_t index) {
+    // Pin before the first job, so whatever the jobs allocate lands on the local node
+    int numaNode = -1;
+    if (index < placements_.size()) {
+        const auto& placement = placements_[index];
+        if (!placement.cpus.empty() && !pinCurrentThread(placement.cpus)) {
+            std::cerr << "ThreadPool: could not pin worker " << index << "\n";
+        }
+        numaNode = placement.numaNode;
+    }
+
+    // Hazard slots for the lifetime of the worker; a lane pop needs two
+    HazardPointer hp(hazards_);
+    HazardPointer hpNext(hazards_);
+    tlsWorker = WorkerSlot{this, index, &hp, &hpNext, numaNode};
+    // A stop request wakes parked workers at once, no polling
+    std::stop_callback onStop(st, [this] { wakeAll(); });
+
+    // One clock read per job: busy time runs from a job start to the next start, or to
+    // the moment the worker runs out of work; idle time from then to the next start.
+    WorkerCounters& counters = counters_[index];
+    const bool surplus = elastic_ && index >= limits_.minWorkers;
+    std::uint64_t since = nowNs();
+    bool idle = true;
+
+    while (true) {
+        if (!tryClaim()) {
+            if (!idle) {
+                const std::uint64_t now = nowNs();
+                addTo(counters.busyNs, now - since);
+                since = now;
+                idle = true;
+            }
+            if (!waitForJob(st, surplus)) return;
+        }
+
+        Claim claim = findJob(index, hp, hpNext, st);
 
         // Run the job
-        if (node) {
-            try {
-                node->job();
-            } catch (...) {
-                // Handle or log the exception
-                std::cerr << "Exception in worker thread\n";
+        if (claim.job) {
+            const std::uint64_t start = nowNs();
+            addTo(idle ? counters.idleNs : counters.busyNs, start - since);
+            since = start;
+            idle = false;
+            if (claim.enqueuedAt != 0) {
+                const std::uint64_t waited = start > claim.enqueuedAt ? start - claim.enqueuedAt : 0;
+                addTo(counters.queueWait[LatencyHistogram::bucketFor(waited)], 1);
+                if (elastic_ && waited > static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(limits_.spawnAfterWait).count())) {
+                    grow(start);
+                }
             }
-            delete node;
+
+            runJob(claim.job, &counters);
         } else if (st.stop_requested()) {
             return;
         }
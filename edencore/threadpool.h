@@ -1,20 +1,72 @@
 #pragma once
 
 #include <stop_token>
-#include <semaphore>
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <vector>
+#include <memory>
 #include <cstddef>
+#include <span>
+
+#include "concurrency.h"
+#include "cputopology.h"
+#include "executorstats.h"
+#include "hazardpointer.h"
+#include "job.h"
+#include "mpmcqueue.h"
+#include "nodepool.h"
+#include "workstealingdeque.h"
 
 namespace eden {
 
+class TimerWheel;
+
 // Abstract interface for any task executor (thread pool, event loop, etc.)
 struct IThreadExecutor {
     virtual ~IThreadExecutor() = default;
     /// Schedule a void() job for execution
-    virtual void enqueue(std::function<void()> job) = 0;
+    virtual void enqueue(Job job) = 0;
+    /// Schedule with a priority hint; the default ignores it
+    virtual void enqueue(Job job, JobPriority priority) {
+        (void)priority;
+        enqueue(std::move(job));
+    }
+    /// Schedule a batch of jobs (left moved-from); the default enqueues them one by one
+    virtual void enqueueBulk(std::span<Job> jobs, JobPriority priority) {
+        for (Job& job : jobs) enqueue(std::move(job), priority);
+    }
+    void enqueueBulk(std::span<Job> jobs) { enqueueBulk(jobs, JobPriority::Normal); }
+    /// Number of jobs that may run at the same time, used to split data-parallel work
+    virtual std::size_t concurrency() const noexcept { return 1; }
+    /// Run one queued job on the calling thread, if there is one (help-while-waiting).
+    /// Returns false when nothing was waiting; the default never helps.
+    virtual bool tryRunPendingJob() { return false; }
+
+    /// True when enqueueAfter/enqueueEvery are available
+    virtual bool hasTimers() const noexcept { return false; }
+    /// Schedule job once after delay; executors without timers throw std::logic_error
+    virtual TimerId enqueueAfter(std::chrono::nanoseconds delay, Job job) {
+        (void)delay;
+        (void)job;
+        throw std::logic_error("enqueueAfter: executor has no timers");
+    }
+    /// Schedule job every period, the first time one period from now
+    virtual TimerId enqueueEvery(std::chrono::nanoseconds period, Job job) {
+        (void)period;
+        (void)job;
+        throw std::logic_error("enqueueEvery: executor has no timers");
+    }
+    /// Cancel a pending timer; false if unknown or already fired (one-shot)
+    virtual bool cancelTimer(TimerId id) {
+        (void)id;
+        return false;
+    }
 };
 
 // Abstract source of “how many threads should we use?”
@@ -31,37 +83,267 @@ struct IThreadCountProvider {
     }
 };
 
+/// Where a worker runs: the CPUs it may use (empty = anywhere) and its NUMA node (-1 = unknown)
+struct WorkerPlacement {
+    std::vector<unsigned> cpus;
+    int numaNode = -1;
+};
+
+/// Thread count provider that also places each worker on the machine
+struct IThreadPlacementProvider : IThreadCountProvider {
+    virtual WorkerPlacement placementFor(std::size_t worker) const = 0;
+};
+
+/// How TopologyProvider pins workers
+enum class PinningPolicy {
+    // No affinity, the NUMA node is still reported
+    None,
+    // One logical CPU per worker
+    Core,
+    // Any CPU of the worker's socket: the OS balances within the socket, memory stays local
+    Socket
+};
+
+/**
+ * @brief Placement from the CPU topology (see CpuTopology)
+ * @details One worker per usable logical CPU. Workers fill a socket before the next,
+ * and the physical cores of a socket before their SMT siblings, so a pool smaller
+ * than the machine gets whole cores on as few sockets as possible.
+ * With excludeSmtSiblings only the first hardware thread of each core is used.
+ */
+class TopologyProvider : public IThreadPlacementProvider {
+public:
+    explicit TopologyProvider(CpuTopology topology = CpuTopology::detect(),
+                              PinningPolicy policy = PinningPolicy::Core,
+                              bool excludeSmtSiblings = false);
+
+    std::size_t getThreadCount() const noexcept override { return order_.size(); }
+    WorkerPlacement placementFor(std::size_t worker) const override;
+
+    [[nodiscard]] const CpuTopology& topology() const noexcept { return topology_; }
+
+private:
+    CpuTopology topology_;
+    PinningPolicy policy_;
+    // Usable CPUs in worker order
+    std::vector<LogicalCpu> order_;
+};
+
+/// How the pool distributes jobs between its workers
+enum class SchedulingMode {
+    // Every job goes through one global lock-free stack (LIFO)
+    SharedStack,
+    // Each worker owns a deque; jobs enqueued by a worker stay local, idle workers steal
+    WorkStealing,
+    // One lock-free FIFO queue per JobPriority; workers always drain the highest
+    // non-empty level first (strict priority, so a flood of High jobs starves Low ones)
+    Priority
+};
+
+/**
+ * @brief Bounds of an elastic pool
+ * @details minWorkers threads run for the lifetime of the pool. When a job starts more
+ * than spawnAfterWait after it was enqueued, another worker is started, at most one
+ * per spawnAfterWait and never more than maxWorkers in total. A worker above
+ * minWorkers that found nothing to run for retireAfterIdle exits.
+ */
+struct ElasticLimits {
+    std::size_t minWorkers = 1;
+    std::size_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    std::chrono::microseconds spawnAfterWait{500};
+    std::chrono::milliseconds retireAfterIdle{5000};
+};
+
 // Thread pool implementation
 class ThreadPool : public IThreadExecutor {
 public:
     // Build with explicit thread-count
-    explicit ThreadPool(std::size_t nThreads);
+    explicit ThreadPool(std::size_t nThreads, SchedulingMode mode = SchedulingMode::SharedStack);
 
     // Build by querying a provider
-    explicit ThreadPool(const IThreadCountProvider& prov)
-      : ThreadPool(prov.getThreadCount()) {}
+    explicit ThreadPool(const IThreadCountProvider& prov, SchedulingMode mode = SchedulingMode::SharedStack)
+      : ThreadPool(prov.getThreadCount(), mode) {}
+
+    // Build by querying a provider, pinning every worker where it says
+    explicit ThreadPool(const IThreadPlacementProvider& prov, SchedulingMode mode = SchedulingMode::SharedStack);
+
+    // Elastic pool: grows with queue wait and shrinks when idle, within the limits.
+    // Throws std::invalid_argument unless 1 <= minWorkers <= maxWorkers.
+    explicit ThreadPool(const ElasticLimits& limits, SchedulingMode mode = SchedulingMode::SharedStack);
 
     virtual ~ThreadPool() override;  // wakes & joins all threads
 
-    // Schedule a job for execution
-    void enqueue(std::function<void()> job) override;
+    // Schedule a job for execution (JobPriority::Normal)
+    void enqueue(Job job) override;
+    // Only Priority mode honours the hint, the other modes treat every job alike
+    void enqueue(Job job, JobPriority priority) override;
+
+    // Publish a whole batch with a single CAS and a single wake-up
+    using IThreadExecutor::enqueueBulk;
+    void enqueueBulk(std::span<Job> jobs, JobPriority priority) override;
+
+    // Snapshot of the per-worker counters; safe to call while the pool is running.
+    // An elastic pool reports every worker slot, retired ones included.
+    // Queue wait is sampled (1 job in 16 per submitting thread, every enqueueBulk batch),
+    // except in an elastic pool which times every job to decide when to grow.
+    [[nodiscard]] ExecutorStats stats() const;
+
+    // NUMA node of the calling pool worker, -1 if unknown or not called from a worker.
+    // Workers are pinned, so memory a job first touches is allocated on this node.
+    static int currentNumaNode() noexcept;
+
+    [[nodiscard]] SchedulingMode mode() const noexcept { return mode_; }
+    // Workers running now; constant unless the pool is elastic
+    [[nodiscard]] std::size_t size() const noexcept { return active_.load(std::memory_order_relaxed); }
+    std::size_t concurrency() const noexcept override { return size(); }
+    [[nodiscard]] bool elastic() const noexcept { return elastic_; }
+
+    // Delayed and periodic jobs, driven by a TimerWheel started on first use.
+    // Timers still pending when the pool is destroyed are dropped. Once destruction has
+    // begun, a job arming a timer gets 0 (no timer) and its job is dropped.
+    bool hasTimers() const noexcept override { return true; }
+    TimerId enqueueAfter(std::chrono::nanoseconds delay, Job job) override;
+    TimerId enqueueEvery(std::chrono::nanoseconds period, Job job) override;
+    bool cancelTimer(TimerId id) override;
+
+    // Take one queued job and run it here. From a worker, its own deque comes first
+    // (in WorkStealing mode the most recent sub-jobs), then the shared queues and steals.
+    bool tryRunPendingJob() override;
+
+    // Job nodes allocated on the heap so far. Stops growing once the node pool
+    // covers the peak number of queued jobs (see also Job::heapAllocations()).
+    [[nodiscard]] std::uint64_t allocationCount() const noexcept { return nodes_.allocations(); }
 
 private:
-    // Main loop for each thread
-    void workerLoop(std::stop_token st);
+    ThreadPool(const ElasticLimits& limits, SchedulingMode mode, std::vector<WorkerPlacement> placements,
+               bool elastic);
 
-    // Node structure for lock-free stack
-    struct Node {
-        std::function<void()> job;
-        Node* next;
+    // Node structure for lock-free stack, recycled through nodes_.
+    // Nodes popped from the shared stack go through hazards_ before reuse.
+    struct Node : HazardPointerObject {
+        Job job;
+        Node* next = nullptr;
+        // Link in a priority lane; written concurrently, hence atomic
+        std::atomic<Node*> laneNext{nullptr};
+        // steady_clock time of the enqueue in nanoseconds, 0 when not sampled
+        std::uint64_t enqueuedAt = 0;
+        bool shared = false;
     };
 
-    // Top of the lock-free stack
+    // A job taken off a queue, and when it was enqueued
+    struct Claim {
+        Job job;
+        std::uint64_t enqueuedAt = 0;
+    };
+
+    // Statistics of one worker. Only that worker writes them (plain load + store,
+    // no read-modify-write), stats() reads them; padded against false sharing.
+    struct alignas(64) WorkerCounters {
+        std::atomic<std::uint64_t> jobs{0};
+        std::atomic<std::uint64_t> steals{0};
+        std::atomic<std::uint64_t> exceptions{0};
+        std::atomic<std::uint64_t> busyNs{0};
+        std::atomic<std::uint64_t> idleNs{0};
+        std::array<std::atomic<std::uint64_t>, LatencyHistogram::kBuckets> queueWait{};
+    };
+
+    using LaneQueue = IntrusiveMpmcQueue<Node, &Node::laneNext>;
+
+    // Main loop for each thread
+    void workerLoop(std::stop_token st, std::size_t index);
+
+    // Adaptive wait for a job token: bounded spin, then yield, then park on wakeEpoch_.
+    // A surplus worker of an elastic pool polls instead of parking, so that it can retire.
+    // Returns false once stop has been requested, or when the surplus worker retires.
+    bool waitForJob(const std::stop_token& st, bool surplus);
+
+    // Start a worker in slot index
+    void startWorker(std::size_t index);
+
+    // Elastic pool: start one more worker if a job waited too long (throttled)
+    void grow(std::uint64_t now);
+
+    // Under timersMutex_: the timer wheel, created by the first caller; nullptr once
+    // the pool is being destroyed
+    TimerWheel* timers();
+
+    // Take one job token if any is available
+    bool tryClaim() noexcept;
+
+    // Publish `count` new jobs and wake parked workers if there are any
+    void notifyJobs(std::int64_t count);
+
+    // Wake every parked worker (stop requests)
+    void wakeAll() noexcept;
+
+    // Find a job once a token has been claimed: priority lanes, or local deque, shared stack,
+    // then steal. index is NodePool<Node>::kNoCache for a thread outside the pool.
+    // Returns an empty Job only on shutdown.
+    Claim findJob(std::size_t index, HazardPointer& hp, HazardPointer& hpNext, const std::stop_token& st);
+
+    // Run a job, catching (and counting, for a worker) what it throws
+    void runJob(Job& job, WorkerCounters* counters) noexcept;
+
+    // Move the job out of a popped stack/deque node and recycle the node
+    Claim takeJob(Node* node, std::size_t cache);
+
+    // Lock-free push/pop on the shared stack; a chain is linked through next, first to last
+    void pushShared(Node* node);
+    void pushSharedChain(Node* first, Node* last);
+    Node* popShared(HazardPointer& hp);
+
+    // Priority lanes: FIFO within a level, highest level first
+    void pushLane(Node* node, JobPriority priority);
+    void pushLaneChain(Node* first, Node* last, JobPriority priority);
+    Claim popLanes(HazardPointer& hp, HazardPointer& hpNext);
+
+    // Give an emptied node back, deferring reuse while another thread may still read it
+    void recycle(Node* node, std::size_t cache);
+    static void reclaimNode(HazardPointerObject* obj, void* ctx);
+
+    // Try every other worker's deque once, starting at a pseudo-random victim
+    Node* steal(std::size_t thief);
+
+    SchedulingMode mode_;
+    // Recycled job nodes, one cache per worker
+    NodePool<Node> nodes_;
+    // Protects shared stack and lane nodes from reuse while a concurrent pop still reads them.
+    // Declared after nodes_: its destructor hands the last retired nodes back to it.
+    HazardPointerDomain hazards_;
+    // Top of the lock-free stack, used by external submitters in every mode
     std::atomic<Node*> head_{nullptr};
-    // Semaphore to notify waiting threads
-    std::counting_semaphore<INT_MAX> sem_{0};
-    // Vector of threads
+    // Per-worker deques (WorkStealing mode only)
+    std::vector<std::unique_ptr<WorkStealingDeque<Node*>>> locals_;
+    // One queue per JobPriority, indexed by its value (Priority mode only)
+    std::array<std::unique_ptr<LaneQueue>, kJobPriorityCount> lanes_;
+    // Jobs published but not yet claimed by a worker (one token per job)
+    alignas(64) std::atomic<std::int64_t> pending_{0};
+    // Parked workers wait on this counter; bumped to wake them up
+    alignas(64) std::atomic<std::uint32_t> wakeEpoch_{0};
+    // Number of parked (or about to park) workers, lets enqueue skip the futex wake
+    std::atomic<std::uint32_t> sleepers_{0};
+    // One per worker, see stats()
+    std::unique_ptr<WorkerCounters[]> counters_;
+    // Per-worker CPU set and NUMA node, empty without a placement provider
+    std::vector<WorkerPlacement> placements_;
+    // Elastic pool: slots [0, minWorkers) always run, the others come and go
+    bool elastic_ = false;
+    ElasticLimits limits_;
+    // Workers running now
+    std::atomic<std::size_t> active_{0};
+    // Steady clock time of the last elastic spawn, throttles growth
+    std::atomic<std::uint64_t> lastSpawnNs_{0};
+    // One flag per slot, cleared by a worker on its way out
+    std::unique_ptr<std::atomic<bool>[]> running_;
+    // Guards workers_ slots against concurrent spawns and shutdown
+    std::mutex growMutex_;
+    bool stopping_ = false;
+    // One slot per possible worker; a retired worker's thread is joined when its slot is reused
     std::vector<std::jthread> workers_;
+    // Delayed and periodic jobs, see timers()
+    std::mutex timersMutex_;
+    bool timersClosed_ = false;
+    std::unique_ptr<TimerWheel> timers_;
 };
 
 } // namespace eden
@@ -0,0 +1,237 @@
+#include "timerwheel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace eden {
+
+namespace {
+
+constexpr std::uint64_t spanOf(std::size_t level) noexcept {
+    return std::uint64_t{1} << (TimerWheel::kSlotBits * level);
+}
+
+} // namespace
+
+struct TimerWheel::Periodic {
+    Job job;
+    // Set while a run is queued or running, further runs are skipped meanwhile
+    std::atomic<bool> running{false};
+};
+
+TimerWheel::TimerWheel(IThreadExecutor& executor, std::chrono::nanoseconds tick)
+  : executor_(executor),
+    tick_(tick.count() > 0 ? tick : std::chrono::nanoseconds(std::chrono::milliseconds(1))),
+    start_(Clock::now()),
+    thread_([this](std::stop_token st) { run(st); }) {}
+
+TimerWheel::~TimerWheel() {
+    thread_.request_stop();
+    thread_.join();
+    for (auto& [id, timer] : timers_) delete timer;
+}
+
+std::uint64_t TimerWheel::ticksFor(std::chrono::nanoseconds d) const noexcept {
+    if (d.count() <= 0) return 0;
+    return static_cast<std::uint64_t>((d.count() + tick_.count() - 1) / tick_.count());
+}
+
+std::uint64_t TimerWheel::currentTick() const noexcept {
+    return static_cast<std::uint64_t>((Clock::now() - start_) / tick_);
+}
+
+TimerId TimerWheel::after(std::chrono::nanoseconds delay, Job job) {
+    return add(ticksFor(delay), 0, std::move(job));
+}
+
+TimerId TimerWheel::every(std::chrono::nanoseconds period, Job job) {
+    const std::uint64_t ticks = std::max<std::uint64_t>(1, ticksFor(period));
+    return add(ticks, ticks, std::move(job));
+}
+
+TimerId TimerWheel::add(std::uint64_t delayTicks, std::uint64_t periodTicks, Job job) {
+    auto* timer = new Timer;
+    timer->period = periodTicks;
+    if (periodTicks > 0) {
+        timer->periodic = std::make_shared<Periodic>();
+        timer->periodic->job = std::move(job);
+    } else {
+        timer->job = std::move(job);
+    }
+
+    std::lock_guard lock(mutex_);
+    timer->id = nextId_++;
+    // Never in the tick being processed: due at the earliest on the next one
+    timer->expiry = std::max(currentTick() + delayTicks, now_ + 1);
+    insert(timer);
+    timers_.emplace(timer->id, timer);
+
+    // Only wake the timer thread if it sleeps past the new deadline
+    if (sleepUntil_ == 0 || timer->expiry < sleepUntil_) wake_.notify_one();
+    return timer->id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    Timer* timer = nullptr;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = timers_.find(id);
+        if (it == timers_.end()) return false;
+        timer = it->second;
+        timers_.erase(it);
+        unlink(timer);
+    }
+    // The sleeping thread may wake for nothing, cheaper than waking it now
+    delete timer;
+    return true;
+}
+
+std::size_t TimerWheel::pending() const {
+    std::lock_guard lock(mutex_);
+    return timers_.size();
+}
+
+/*
+Placement:
+A timer due in delta ticks goes to the lowest level whose span covers it: level L holds
+deltas in [64^L, 64^(L+1)), in the slot given by bits [6L, 6L + 6) of its expiry tick.
+That slot is cascaded, and its timers re-inserted lower, at the first tick past now_
+whose low 6L bits are zero and whose next 6 bits equal the slot: at or before expiry.
+Timers beyond the last level's span are parked in its farthest slot and re-sorted
+each time that slot is cascaded.
+*/
+void TimerWheel::insert(Timer* timer) {
+    const std::uint64_t delta = timer->expiry > now_ ? timer->expiry - now_ : 0;
+    std::size_t level = 0;
+    while (level + 1 < kLevels && delta >= spanOf(level + 1)) ++level;
+
+    std::uint64_t position = timer->expiry;
+    if (delta >= spanOf(kLevels)) position = now_ + spanOf(kLevels) - 1;
+    const auto slot = static_cast<std::size_t>((position >> (kSlotBits * level)) & (kSlots - 1));
+
+    timer->level = static_cast<std::uint8_t>(level);
+    timer->slot = static_cast<std::uint8_t>(slot);
+    timer->prev = nullptr;
+    timer->next = slots_[level][slot];
+    if (timer->next) timer->next->prev = timer;
+    slots_[level][slot] = timer;
+    occupied_[level] |= std::uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(Timer* timer) noexcept {
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        slots_[timer->level][timer->slot] = timer->next;
+    }
+    if (timer->next) timer->next->prev = timer->prev;
+    if (!slots_[timer->level][timer->slot]) occupied_[timer->level] &= ~(std::uint64_t{1} << timer->slot);
+    timer->prev = timer->next = nullptr;
+}
+
+void TimerWheel::cascade(std::size_t level) {
+    const auto slot = static_cast<std::size_t>((now_ >> (kSlotBits * level)) & (kSlots - 1));
+    Timer* timer = slots_[level][slot];
+    slots_[level][slot] = nullptr;
+    occupied_[level] &= ~(std::uint64_t{1} << slot);
+    while (timer) {
+        Timer* next = timer->next;
+        insert(timer);
+        timer = next;
+    }
+}
+
+std::uint64_t TimerWheel::nextEventTick() const noexcept {
+    std::uint64_t best = 0;
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        if (!occupied_[level]) continue;
+        const std::size_t shift = kSlotBits * level;
+        const std::uint64_t position = now_ >> shift;
+        // Bit k of the rotated mask is the slot k + 1 steps after the current one
+        const auto rotation = static_cast<int>((position + 1) & (kSlots - 1));
+        const auto steps = static_cast<std::uint64_t>(std::countr_zero(std::rotr(occupied_[level], rotation))) + 1;
+        const std::uint64_t tick = (position + steps) << shift;
+        if (best == 0 || tick < best) best = tick;
+    }
+    return best;
+}
+
+void TimerWheel::advance(std::uint64_t to, std::vector<Timer*>& due) {
+    while (true) {
+        const std::uint64_t tick = nextEventTick();
+        if (tick == 0 || tick > to) {
+            // Nothing happens in between: jump straight there
+            now_ = std::max(now_, to);
+            return;
+        }
+        now_ = tick;
+        // Highest level first, so timers it moves down can still be cascaded further
+        for (std::size_t level = kLevels - 1; level > 0; --level) {
+            if ((now_ & (spanOf(level) - 1)) == 0) cascade(level);
+        }
+
+        const auto slot = static_cast<std::size_t>(now_ & (kSlots - 1));
+        while (Timer* timer = slots_[0][slot]) {
+            unlink(timer);
+            due.push_back(timer);
+        }
+    }
+}
+
+void TimerWheel::run(std::stop_token st) {
+    std::vector<Timer*> due;
+    std::vector<Job> ready;
+
+    std::unique_lock lock(mutex_);
+    while (!st.stop_requested()) {
+        const std::uint64_t next = nextEventTick();
+        sleepUntil_ = next;
+        if (next == 0) {
+            // No timer at all: sleep until one is added
+            wake_.wait(lock, st, [this] { return nextEventTick() != 0; });
+        } else {
+            // An earlier timer (or a cancel) changes the next event and restarts the wait
+            wake_.wait_until(lock, st, start_ + next * tick_,
+                             [this, next] { return nextEventTick() != next || currentTick() >= next; });
+        }
+        if (st.stop_requested()) break;
+
+        advance(currentTick(), due);
+        for (Timer* timer : due) {
+            if (timer->period == 0) {
+                timers_.erase(timer->id);
+                ready.push_back(std::move(timer->job));
+                delete timer;
+                continue;
+            }
+
+            // Fixed rate: the next run keeps the original phase, runs missed meanwhile are dropped
+            const std::uint64_t late = now_ - timer->expiry;
+            timer->expiry += timer->period * (late / timer->period + 1);
+            insert(timer);
+            if (!timer->periodic->running.exchange(true, std::memory_order_acq_rel)) {
+                ready.push_back([periodic = timer->periodic] {
+                    struct Done {
+                        Periodic& p;
+                        ~Done() { p.running.store(false, std::memory_order_release); }
+                    } done{*periodic};
+                    periodic->job();
+                });
+            }
+        }
+        due.clear();
+        if (ready.empty()) continue;
+
+        // Hand the jobs over outside the lock, add() and cancel() stay responsive
+        lock.unlock();
+        for (Job& job : ready) executor_.enqueue(std::move(job));
+        ready.clear();
+        lock.lock();
+    }
+}
+
+} // namespace eden
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrency.h"
+#include "job.h"
+
+namespace eden {
+
+struct IThreadExecutor;
+
+/**
+ * @brief Hierarchical timer wheel feeding an executor
+ * @details Four levels of 64 slots. Level 0 holds timers due within 64 ticks, one slot
+ * per tick; each level above covers 64 times the span of the one below and is cascaded
+ * down when level 0 wraps around. Adding and cancelling a timer cost O(1), whatever
+ * the number of timers pending.
+ *
+ * A single thread drives the wheel. It sleeps until the next occupied slot (computed
+ * from per-level occupancy bitmaps) rather than waking every tick, and with no timer
+ * at all it blocks on a condition variable: thousands of pending timers cost nothing
+ * until they are due. Due jobs are handed to the executor; the timer thread never
+ * runs them itself.
+ *
+ * Periodic jobs run at a fixed rate. A run that comes due while the previous one is
+ * still going is skipped, so a slow job never piles up in the queue.
+ */
+class TimerWheel {
+public:
+    static constexpr std::size_t kLevels = 4;
+    static constexpr std::size_t kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(IThreadExecutor& executor, std::chrono::nanoseconds tick = std::chrono::milliseconds(1));
+    // Stops the timer thread; jobs still pending are dropped
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Enqueue job after delay, rounded up to the next tick
+    TimerId after(std::chrono::nanoseconds delay, Job job);
+    // Enqueue job every period (at least one tick), the first time one period from now
+    TimerId every(std::chrono::nanoseconds period, Job job);
+    // Remove a pending timer. Returns false if it is unknown or a one-shot already handed
+    // to the executor; a run already enqueued is not recalled.
+    bool cancel(TimerId id);
+
+    [[nodiscard]] std::size_t pending() const;
+    [[nodiscard]] std::chrono::nanoseconds tick() const noexcept { return tick_; }
+
+private:
+    struct Periodic;
+
+    struct Timer {
+        TimerId id = 0;
+        std::uint64_t expiry = 0;      // tick at which it is due
+        std::uint64_t period = 0;      // ticks, 0 for a one-shot
+        Job job;                        // one-shot
+        std::shared_ptr<Periodic> periodic;
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+        std::uint8_t level = 0;
+        std::uint8_t slot = 0;
+    };
+
+    TimerId add(std::uint64_t delayTicks, std::uint64_t periodTicks, Job job);
+    std::uint64_t ticksFor(std::chrono::nanoseconds d) const noexcept;
+    std::uint64_t currentTick() const noexcept;
+
+    // Slot bookkeeping, called with mutex_ held
+    void insert(Timer* timer);
+    void unlink(Timer* timer) noexcept;
+    void cascade(std::size_t level);
+    // First tick after now_ at which something happens (a timer is due, or a slot
+    // must be cascaded), 0 when the wheel is empty
+    std::uint64_t nextEventTick() const noexcept;
+    // Move now_ forward to `to`, collecting the timers that come due
+    void advance(std::uint64_t to, std::vector<Timer*>& due);
+
+    void run(std::stop_token st);
+
+    IThreadExecutor& executor_;
+    const std::chrono::nanoseconds tick_;
+    const Clock::time_point start_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any wake_;
+    // Tick the wheel has been advanced to
+    std::uint64_t now_ = 0;
+    // Tick the timer thread sleeps until, 0 while it waits for a first timer
+    std::uint64_t sleepUntil_ = 0;
+    TimerId nextId_ = 1;
+    std::array<std::array<Timer*, kSlots>, kLevels> slots_{};
+    std::array<std::uint64_t, kLevels> occupied_{};
+    std::unordered_map<TimerId, Timer*> timers_;
+
+    std::jthread thread_;
+};
+
+} // namespace eden
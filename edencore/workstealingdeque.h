@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace eden {
+
+/**
+ * @brief Chase-Lev work-stealing deque
+ * @details Single-owner, multi-thief deque as described in
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013).
+ *
+ * - The owner thread pushes and pops at the bottom (LIFO, cache-hot).
+ * - Any other thread steals from the top (FIFO, oldest work first).
+ * - Only the owner and a thief racing for the very last element contend on a CAS.
+ *
+ * The circular buffer grows on demand. Retired buffers are kept alive until the
+ * deque is destroyed because a thief may still be reading from them.
+ *
+ * T must be trivially copyable (typically a pointer to a job node).
+ */
+template <class T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque stores trivially copyable values");
+
+private:
+    struct Array {
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> buffer;
+
+        explicit Array(std::int64_t cap)
+          : capacity(cap), mask(cap - 1), buffer(std::make_unique<std::atomic<T>[]>(cap)) {}
+
+        T get(std::int64_t i) const noexcept { return buffer[i & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T x) noexcept { buffer[i & mask].store(x, std::memory_order_relaxed); }
+
+        // Copy the live range [top, bottom) into a buffer twice as large
+        Array* grow(std::int64_t bottom, std::int64_t top) const {
+            auto* bigger = new Array(capacity * 2);
+            for (std::int64_t i = top; i != bottom; ++i) {
+                bigger->put(i, get(i));
+            }
+            return bigger;
+        }
+    };
+
+    // top_ and bottom_ live on separate cache lines: thieves hammer top_, the owner bottom_
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_;
+    // Buffers replaced by grow(), owner-only
+    std::vector<std::unique_ptr<Array>> garbage_;
+
+public:
+    explicit WorkStealingDeque(std::int64_t capacity = 1024) {
+        // Capacity must be a power of two for the index mask
+        std::int64_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        array_.store(new Array(cap), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingDeque() {
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only: push at the bottom
+    void push(T x) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+
+        if (b - t > a->capacity - 1) {
+            Array* bigger = a->grow(b, t);
+            garbage_.emplace_back(a);
+            array_.store(bigger, std::memory_order_release);
+            a = bigger;
+        }
+
+        a->put(b, x);
+        // Publish the element before the new bottom becomes visible to thieves
+        // (pairs with the acquire load in steal; same cost as a release fence)
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only: pop from the bottom
+    std::optional<T> pop() {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        // Order the bottom_ store before the top_ load (Dekker-style with steal())
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty: restore bottom
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T x = a->get(b);
+        if (t == b) {
+            // Last element: race against thieves for it
+            bool won = top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            if (!won) return std::nullopt;
+        }
+        return x;
+    }
+
+    // Any thread: steal from the top. May fail spuriously under contention.
+    std::optional<T> steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) return std::nullopt;
+
+        Array* a = array_.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            // Lost the race to another thief or to the owner
+            return std::nullopt;
+        }
+        return x;
+    }
+
+    // Approximate, for heuristics only
+    [[nodiscard]] std::int64_t size() const noexcept {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+};
+
+} // namespace eden
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <unistd.h>
 #include <fcntl.h>
@@ -6,6 +7,8 @@
 #include <syslog.h>
 #include <signal.h>
 
+#include "threadpool.h"
+
 // Signal handler for SIGTERM
 void signal_handler(int signum) {
     if (signum == SIGTERM) {
@@ -61,11 +64,19 @@ void daemonize() {
 int main() {
     daemonize();
 
-    // Main loop for the daemon
-    while (true) {
+    // Periodic work runs on the pool's timer wheel: no thread sleeps between two runs
+    eden::ThreadPool pool(1);
+    auto heartbeat = [] {
         // Daemon code here (e.g., monitoring tasks, handling requests, etc.)
         syslog(LOG_INFO, "Daemon edend is running.");
-        sleep(60); // Sleep for 60 seconds
+    };
+    // Once at start, then every period
+    pool.enqueue(heartbeat);
+    pool.enqueueEvery(std::chrono::seconds(60), heartbeat);
+
+    // Wait for signals; SIGTERM exits through signal_handler
+    while (true) {
+        pause();
     }
 
     return EXIT_SUCCESS;
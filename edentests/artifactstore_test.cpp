@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "artifactstore.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace eden;
+
+TEST(ArtifactStoreTest, ViewsShareTheStoredObject) {
+    ArtifactStore store;
+    auto published = store.publish(11, std::vector<double>{0.01, 0.015, 0.02});
+
+    auto view = store.get<std::vector<double>>(11);
+    EXPECT_EQ(view.get(), published.get());
+    EXPECT_EQ(view->size(), 3u);
+
+    EXPECT_THROW((void)store.get<std::string>(11), std::invalid_argument);
+    EXPECT_THROW((void)store.get<std::vector<double>>(12), std::out_of_range);
+    EXPECT_THROW(store.publish(12, std::shared_ptr<const int>()), std::invalid_argument);
+}
+
+TEST(ArtifactStoreTest, ReleasedAfterTheLastConsumer) {
+    ArtifactStore store;
+    store.expect(11, 2);
+    store.expect(21, 1);
+    store.pin(21);
+    store.publish(11, std::string("curve"));
+    store.publish(21, std::string("trades"));
+    store.publish(31, std::string("result"));
+
+    auto reader = store.get<std::string>(11);
+    store.consumed(11);
+    EXPECT_TRUE(store.contains(11));
+    store.consumed(11);
+    EXPECT_FALSE(store.contains(11));
+    // A view taken before the release stays valid
+    EXPECT_EQ(*reader, "curve");
+
+    // Pinned for a consumer outside the run; no consumer at all: an output
+    store.consumed(21);
+    EXPECT_TRUE(store.contains(21));
+    EXPECT_TRUE(store.contains(31));
+
+    const auto stats = store.stats();
+    EXPECT_EQ(stats.published, 3u);
+    EXPECT_EQ(stats.released, 1u);
+    EXPECT_EQ(stats.live, 2u);
+    EXPECT_EQ(stats.peakLive, 3u);
+}
+
+TEST(ArtifactStoreTest, ReadsThroughToUpstreamWithoutReleasingIt) {
+    auto shared = std::make_shared<ArtifactStore>();
+    shared->publish(11, 42);
+
+    ArtifactStore scenario(shared);
+    scenario.expect(11, 1);
+    EXPECT_EQ(*scenario.get<int>(11), 42);
+    scenario.consumed(11);
+    EXPECT_TRUE(shared->contains(11));
+    EXPECT_TRUE(scenario.contains(11));
+}
+
+TEST(ArtifactStoreTest, AdoptsArtifactsOfAnEarlierStore) {
+    auto shared = std::make_shared<ArtifactStore>();
+    shared->publish(11, 42);
+    auto earlier = std::make_shared<ArtifactStore>(shared);
+    auto curve = earlier->publish(21, std::string("curve"));
+
+    ArtifactStore next;
+    EXPECT_TRUE(next.adopt(*earlier, 21));
+    EXPECT_TRUE(next.adopt(*earlier, 11));
+    EXPECT_FALSE(next.adopt(*earlier, 31));
+    // The same object, no copy, and no link to the earlier store
+    EXPECT_EQ(next.get<std::string>(21).get(), curve.get());
+    earlier.reset();
+    shared.reset();
+    EXPECT_EQ(*next.get<int>(11), 42);
+    EXPECT_EQ(next.stats().published, 0u);
+    EXPECT_EQ(next.stats().live, 2u);
+}
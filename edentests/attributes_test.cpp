@@ -63,3 +63,10 @@ TEST(AttributesTest, GetterForCob) {
     EXPECT_EQ(attributes.cob(), cob);
 }
 
+
+TEST(AttributesTest, FingerprintIsTheCalendarDate) {
+    // Fixed value: stored cache keys must not depend on the clock's tick or the time zone
+    eden::Attributes attributes(eden::DateTime(2024, 6, 3));
+    EXPECT_EQ(attributes.fingerprint(), eden::Hasher().add(20240603).add(0).value());
+    EXPECT_NE(attributes.fingerprint(), eden::Attributes(eden::DateTime(2024, 6, 4)).fingerprint());
+}
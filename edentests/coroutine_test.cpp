@@ -0,0 +1,364 @@
+#include <gtest/gtest.h>
+#include "coroutine.h"
+#include "coroutinetask.h"
+#include "threadpool.h"
+#include "workflow/workflow.h"
+#include "attributes.h"
+#include "context.h"
+#include "datetime.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace eden;
+
+namespace {
+
+Task<int> constant(int v) {
+    co_return v;
+}
+
+Task<int> add(int a, int b) {
+    const int x = co_await constant(a);
+    const int y = co_await constant(b);
+    co_return x + y;
+}
+
+Task<std::thread::id> threadOn(IThreadExecutor& executor) {
+    co_await schedule_on(executor);
+    co_return std::this_thread::get_id();
+}
+
+Task<int> square(IThreadExecutor& executor, int v) {
+    co_await schedule_on(executor);
+    co_return v * v;
+}
+
+Task<int> failing(IThreadExecutor& executor) {
+    co_await schedule_on(executor);
+    throw std::runtime_error("coroutine failed");
+}
+
+// Coroutine lambdas must not capture: the closure dies before the body resumes.
+// Parameters, on the other hand, are copied into the coroutine frame.
+Task<void> count(IThreadExecutor& executor, std::atomic<int>& counter, bool fail = false) {
+    co_await schedule_on(executor);
+    if (fail) throw std::runtime_error("one failed");
+    counter.fetch_add(1);
+}
+
+// Awaitable released by hand: coroutines parked on it hold no thread at all
+class Gate {
+public:
+    struct Awaiter {
+        Gate& gate;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard lock(gate.mutex_);
+            gate.waiting_.push_back(h);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    Awaiter operator co_await() noexcept { return Awaiter{*this}; }
+
+    // Resume every parked coroutine on the executor
+    std::size_t open(IThreadExecutor& executor) {
+        std::vector<std::coroutine_handle<>> waiting;
+        {
+            std::lock_guard lock(mutex_);
+            waiting.swap(waiting_);
+        }
+        for (auto h : waiting) executor.enqueue([h] { h.resume(); });
+        return waiting.size();
+    }
+
+    std::size_t size() {
+        std::lock_guard lock(mutex_);
+        return waiting_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::coroutine_handle<>> waiting_;
+};
+
+} // namespace
+
+TEST(CoroutineTest, TasksAreLazyAndChain) {
+    EXPECT_EQ(sync_wait(add(20, 22)), 42);
+
+    bool started = false;
+    auto task = [](bool& flag) -> Task<void> {
+        flag = true;
+        co_return;
+    }(started);
+    EXPECT_FALSE(started);
+    sync_wait(std::move(task));
+    EXPECT_TRUE(started);
+}
+
+TEST(CoroutineTest, ScheduleOnResumesOnThePool) {
+    ThreadPool pool(2);
+    EXPECT_NE(sync_wait(threadOn(pool)), std::this_thread::get_id());
+}
+
+TEST(CoroutineTest, ExceptionsReachTheAwaiter) {
+    ThreadPool pool(2);
+    EXPECT_THROW(sync_wait(failing(pool)), std::runtime_error);
+
+    auto outer = [](IThreadExecutor& executor) -> Task<bool> {
+        try {
+            co_await failing(executor);
+        } catch (const std::runtime_error&) {
+            co_return true;
+        }
+        co_return false;
+    };
+    EXPECT_TRUE(sync_wait(outer(pool)));
+}
+
+TEST(CoroutineTest, WhenAllKeepsTheInputOrder) {
+    ThreadPool pool(4);
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 100; ++i) tasks.push_back(square(pool, i));
+    const auto results = sync_wait(when_all(std::move(tasks)));
+
+    ASSERT_EQ(results.size(), 100u);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(results[i], i * i);
+
+    // Empty and void groups
+    EXPECT_TRUE(sync_wait(when_all(std::vector<Task<int>>{})).empty());
+    std::atomic<int> counter{0};
+    std::vector<Task<void>> voids;
+    for (int i = 0; i < 10; ++i) voids.push_back(count(pool, counter));
+    sync_wait(when_all(std::move(voids)));
+    EXPECT_EQ(counter.load(), 10);
+}
+
+TEST(CoroutineTest, WhenAllRethrowsAfterEveryTaskFinished) {
+    ThreadPool pool(2);
+    std::atomic<int> finished{0};
+    std::vector<Task<void>> tasks;
+    for (int i = 0; i < 20; ++i) tasks.push_back(count(pool, finished, i == 3));
+    EXPECT_THROW(sync_wait(when_all(std::move(tasks))), std::runtime_error);
+    EXPECT_EQ(finished.load(), 19);
+}
+
+TEST(CoroutineTest, WhenAnyReturnsTheFirstToFinish) {
+    ThreadPool pool(2);
+    Gate slow;
+    std::vector<Task<int>> tasks;
+    tasks.push_back([](Gate& gate) -> Task<int> {
+        co_await gate;
+        co_return 1;
+    }(slow));
+    tasks.push_back(square(pool, 7));
+
+    auto [index, value] = sync_wait(when_any(std::move(tasks)));
+    EXPECT_EQ(index, 1u);
+    EXPECT_EQ(value, 49);
+
+    // The loser is still parked; it finishes on its own once released
+    ASSERT_EQ(slow.size(), 1u);
+    slow.open(pool);
+
+    EXPECT_THROW(sync_wait(when_any(std::vector<Task<int>>{})), std::invalid_argument);
+}
+
+TEST(CoroutineTest, SuspendedTasksHoldNoThread) {
+    // Far more tasks in flight than workers: all of them parked at once on the gate
+    ThreadPool pool(2);
+    Gate gate;
+    std::atomic<int> done{0};
+    constexpr int n = 2000;
+
+    std::vector<Task<void>> tasks;
+    for (int i = 0; i < n; ++i) {
+        tasks.push_back([](IThreadExecutor& executor, Gate& g, std::atomic<int>& counter) -> Task<void> {
+            co_await schedule_on(executor);
+            co_await g;
+            counter.fetch_add(1);
+        }(pool, gate, done));
+    }
+
+    std::thread opener([&] {
+        while (gate.size() < static_cast<std::size_t>(n)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(done.load(), 0);
+        gate.open(pool);
+    });
+    sync_wait(when_all(std::move(tasks)));
+    opener.join();
+    EXPECT_EQ(done.load(), n);
+}
+
+namespace {
+
+class GatedTask : public CoroutineTask {
+public:
+    GatedTask(TaskID id, IThreadExecutor& executor, Gate& gate, std::atomic<int>& order)
+      : CoroutineTask(id, "Gated", 0, 0), executor_(executor), gate_(gate), order_(order) {}
+
+    void prepare(const AttributeSPtr&, const ContextSPtr&) override {}
+
+    Task<void> runAsync(const AttributeSPtr&, const ContextSPtr&) override {
+        co_await gate_;
+        co_await schedule_on(executor_);
+        finishedAt = order_.fetch_add(1);
+    }
+
+    std::atomic<int> finishedAt{-1};
+
+private:
+    IThreadExecutor& executor_;
+    Gate& gate_;
+    std::atomic<int>& order_;
+};
+
+class OrderTask : public ITask {
+public:
+    OrderTask(TaskID id, std::atomic<int>& order) : ITask(id, "Order", 0, 0), order_(order) {}
+    void prepare(const AttributeSPtr&, const ContextSPtr&) override {}
+    void run(const AttributeSPtr&, const ContextSPtr&) override { ranAt = order_.fetch_add(1); }
+
+    // Read by the test while a worker writes it
+    std::atomic<int> ranAt{-1};
+
+private:
+    std::atomic<int>& order_;
+};
+
+} // namespace
+
+TEST(CoroutineTest, WorkflowReleasesDependentsWhenTheCoroutineFinishes) {
+    const AttributeSPtr attr = std::make_shared<Attributes>(DateTime(2024, 6, 3));
+    const ContextSPtr ctx = std::make_shared<TaskContext>();
+    Workflow wf("Coroutines", attr, ctx);
+
+    // A single worker: the gated task must release it while it waits
+    ThreadPool pool(1);
+    Gate gate;
+    std::atomic<int> order{0};
+    auto gated = std::make_shared<GatedTask>(1, pool, gate, order);
+    auto independent = std::make_shared<OrderTask>(2, order);
+    auto after = std::make_shared<OrderTask>(3, order);
+    wf.addTask(1, gated);
+    wf.addTask(2, independent);
+    wf.addTask(3, after);
+    wf.dependsOn(3, 1);
+
+    std::thread opener([&] {
+        while (gate.size() == 0 || independent->ranAt.load() < 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        gate.open(pool);
+    });
+    wf.run(pool);
+    opener.join();
+
+    EXPECT_EQ(independent->ranAt.load(), 0);
+    EXPECT_EQ(gated->finishedAt.load(), 1);
+    EXPECT_EQ(after->ranAt.load(), 2);
+}
+
+namespace {
+
+// Polls its stop token between hops on the executor, never holding a worker for long
+class StoppableTask : public CoroutineTask {
+public:
+    StoppableTask(TaskID id, IThreadExecutor& executor, std::atomic<int>& attempts)
+      : CoroutineTask(id, "Stoppable", 0, 0), executor_(executor), attempts_(attempts) {}
+
+    void prepare(const AttributeSPtr&, const ContextSPtr&) override {}
+
+    Task<void> runAsync(const AttributeSPtr&, const ContextSPtr&) override { co_return; }
+
+    Task<void> runAsyncCancellable(const AttributeSPtr&, const ContextSPtr&, std::stop_token stop) override {
+        attempts_.fetch_add(1);
+        while (!stop.stop_requested()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            co_await schedule_on(executor_);
+        }
+    }
+
+private:
+    IThreadExecutor& executor_;
+    std::atomic<int>& attempts_;
+};
+
+} // namespace
+
+TEST(CoroutineTest, WorkflowTimesOutCoroutineTasks) {
+    const AttributeSPtr attr = std::make_shared<Attributes>(DateTime(2024, 6, 3));
+    const ContextSPtr ctx = std::make_shared<TaskContext>();
+    Workflow wf("Coroutines", attr, ctx);
+
+    ThreadPool pool(2);
+    std::atomic<int> attempts{0};
+    std::atomic<int> order{0};
+    auto hung = std::make_shared<StoppableTask>(1, pool, attempts);
+    TaskPolicy policy;
+    policy.maxAttempts = 2;
+    policy.timeout = std::chrono::milliseconds(20);
+    hung->setPolicy(policy);
+    wf.addTask(1, hung);
+    wf.addTask(2, std::make_shared<OrderTask>(2, order));
+    wf.dependsOn(2, 1);
+
+    // Each attempt is stopped by its timeout, then the task fails for good
+    EXPECT_THROW(wf.run(pool), TaskTimeoutError);
+    EXPECT_EQ(attempts.load(), 2);
+    EXPECT_EQ(wf.statusOf(1), ITask::Status::Failed);
+    EXPECT_EQ(wf.statusOf(2), ITask::Status::Skipped);
+}
+
+namespace {
+
+// Fails once the coroutine task is in flight
+class FailAfterStartTask : public ITask {
+public:
+    FailAfterStartTask(TaskID id, std::atomic<int>& started) : ITask(id, "FailAfterStart", 0, 0), started_(started) {}
+    void prepare(const AttributeSPtr&, const ContextSPtr&) override {}
+    void run(const AttributeSPtr&, const ContextSPtr&) override {
+        while (started_.load() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        throw std::runtime_error("pricing failed");
+    }
+
+private:
+    std::atomic<int>& started_;
+};
+
+} // namespace
+
+TEST(CoroutineTest, AbortingTheRunStopsCoroutineTasks) {
+    const AttributeSPtr attr = std::make_shared<Attributes>(DateTime(2024, 6, 3));
+    const ContextSPtr ctx = std::make_shared<TaskContext>();
+    ThreadPool pool(2);
+
+    // Another task's failure in AbortRun mode
+    {
+        Workflow wf("Coroutines", attr, ctx);
+        std::atomic<int> attempts{0};
+        wf.addTask(1, std::make_shared<StoppableTask>(1, pool, attempts));
+        wf.addTask(2, std::make_shared<FailAfterStartTask>(2, attempts));
+        wf.setFailureMode(FailureMode::AbortRun);
+        EXPECT_THROW(wf.run(pool), std::runtime_error);
+        EXPECT_EQ(attempts.load(), 1);
+        EXPECT_EQ(wf.statusOf(1), ITask::Status::Skipped);
+        EXPECT_EQ(wf.statusOf(2), ITask::Status::Failed);
+    }
+
+    // WorkflowRun::cancel()
+    {
+        Workflow wf("Coroutines", attr, ctx);
+        std::atomic<int> attempts{0};
+        wf.addTask(1, std::make_shared<StoppableTask>(1, pool, attempts));
+        auto run = wf.runAsync(pool);
+        while (attempts.load() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        run->cancel();
+        EXPECT_THROW(run->wait(), RunCancelledError);
+        EXPECT_EQ(run->status(1), ITask::Status::Skipped);
+    }
+}
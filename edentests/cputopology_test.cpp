@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "cputopology.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <latch>
+#include <string>
+
+using namespace eden;
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << content << "\n";
+}
+
+// 2 sockets x 2 cores x 2 hardware threads, one NUMA node per socket.
+// Numbered like most x86 servers: siblings are n and n + 4.
+std::filesystem::path makeFakeSysfs() {
+    const auto root = std::filesystem::temp_directory_path() / "eden_fake_sysfs";
+    std::filesystem::remove_all(root);
+
+    writeFile(root / "cpu/online", "0-7");
+    for (unsigned id = 0; id < 8; ++id) {
+        const auto topo = root / ("cpu/cpu" + std::to_string(id)) / "topology";
+        const unsigned first = id % 4;
+        writeFile(topo / "core_id", std::to_string(first % 2));
+        writeFile(topo / "physical_package_id", std::to_string(first / 2));
+        writeFile(topo / "thread_siblings_list", std::to_string(first) + "," + std::to_string(first + 4));
+    }
+    writeFile(root / "node/online", "0-1");
+    writeFile(root / "node/node0/cpulist", "0-1,4-5");
+    writeFile(root / "node/node1/cpulist", "2-3,6-7");
+    return root;
+}
+
+} // namespace
+
+TEST(CpuTopologyTest, ParseCpuList) {
+    EXPECT_EQ(CpuTopology::parseCpuList("0-3,8,10-11"), (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(CpuTopology::parseCpuList("5"), (std::vector<unsigned>{5}));
+    EXPECT_TRUE(CpuTopology::parseCpuList("").empty());
+    // Reversed, out of range or overflowing ranges are dropped, not expanded
+    EXPECT_EQ(CpuTopology::parseCpuList("3-1,2"), (std::vector<unsigned>{2}));
+    EXPECT_EQ(CpuTopology::parseCpuList("0-4294967295,1"), (std::vector<unsigned>{1}));
+    EXPECT_EQ(CpuTopology::parseCpuList("1023,1024"), (std::vector<unsigned>{1023}));
+}
+
+TEST(CpuTopologyTest, DetectFromSysfs) {
+    const auto root = makeFakeSysfs();
+    const auto topology = CpuTopology::detect(root.string(), {});
+
+    ASSERT_EQ(topology.cpus().size(), 8u);
+    EXPECT_EQ(topology.coreCount(), 4u);
+    EXPECT_EQ(topology.packageCount(), 2u);
+    EXPECT_EQ(topology.numaNodeCount(), 2u);
+
+    const auto& cpu6 = topology.cpus()[6];
+    EXPECT_EQ(cpu6.package, 1u);
+    EXPECT_EQ(cpu6.numaNode, 1u);
+    EXPECT_EQ(cpu6.smtRank, 1u);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(CpuTopologyTest, DetectKeepsOnlyAllowedCpus) {
+    const auto root = makeFakeSysfs();
+    // A container restricted to one core (both hardware threads) of each socket
+    const std::vector<unsigned> allowed{1, 2, 5, 6, 12};
+    const auto topology = CpuTopology::detect(root.string(), allowed);
+
+    ASSERT_EQ(topology.cpus().size(), 4u);
+    EXPECT_EQ(topology.cpus()[0].id, 1u);
+    EXPECT_EQ(topology.cpus()[3].id, 6u);
+    EXPECT_EQ(topology.coreCount(), 2u);
+    EXPECT_EQ(topology.packageCount(), 2u);
+
+    // The real process mask: every detected CPU is in it
+    const auto mask = CpuTopology::allowedCpus();
+    if (!mask.empty()) {
+        const auto detected = CpuTopology::detect();
+        for (const auto& cpu : detected.cpus()) {
+            EXPECT_NE(std::find(mask.begin(), mask.end(), cpu.id), mask.end());
+        }
+    }
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(CpuTopologyTest, MissingSysfsFallsBackToFlatLayout) {
+    const auto topology = CpuTopology::detect("/nonexistent/eden/sys");
+    EXPECT_GE(topology.cpus().size(), 1u);
+    EXPECT_EQ(topology.packageCount(), 1u);
+    EXPECT_EQ(topology.numaNodeCount(), 1u);
+}
+
+TEST(CpuTopologyTest, ProviderFillsCoresThenSiblings) {
+    const auto root = makeFakeSysfs();
+    const auto topology = CpuTopology::detect(root.string(), {});
+    std::filesystem::remove_all(root);
+
+    TopologyProvider all(topology, PinningPolicy::Core);
+    ASSERT_EQ(all.getThreadCount(), 8u);
+    // Socket 0 cores, socket 0 siblings, then socket 1
+    std::vector<unsigned> order;
+    for (std::size_t i = 0; i < all.getThreadCount(); ++i) order.push_back(all.placementFor(i).cpus.at(0));
+    EXPECT_EQ(order, (std::vector<unsigned>{0, 1, 4, 5, 2, 3, 6, 7}));
+    EXPECT_EQ(all.placementFor(4).numaNode, 1);
+
+    TopologyProvider noSmt(topology, PinningPolicy::Core, true);
+    ASSERT_EQ(noSmt.getThreadCount(), 4u);
+    EXPECT_EQ(noSmt.placementFor(2).cpus, (std::vector<unsigned>{2}));
+
+    TopologyProvider socket(topology, PinningPolicy::Socket, true);
+    EXPECT_EQ(socket.placementFor(3).cpus, (std::vector<unsigned>{2, 3}));
+    EXPECT_EQ(socket.placementFor(3).numaNode, 1);
+
+    TopologyProvider unpinned(topology, PinningPolicy::None);
+    EXPECT_TRUE(unpinned.placementFor(0).cpus.empty());
+}
+
+TEST(CpuTopologyTest, PinnedWorkersReportTheirNode) {
+    TopologyProvider provider(CpuTopology::detect(), PinningPolicy::Core);
+    std::atomic<int> unknown{0};
+    constexpr int jobs = 64;
+    std::latch done(jobs);
+    {
+        ThreadPool pool(provider);
+        EXPECT_EQ(pool.size(), provider.getThreadCount());
+        for (int i = 0; i < jobs; ++i) {
+            pool.enqueue([&] {
+                if (ThreadPool::currentNumaNode() < 0) unknown.fetch_add(1);
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+    EXPECT_EQ(unknown.load(), 0);
+    EXPECT_EQ(ThreadPool::currentNumaNode(), -1);
+}
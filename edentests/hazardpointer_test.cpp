@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "hazardpointer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace eden;
+
+namespace {
+
+struct TrackedNode : HazardPointerObject {
+    int value = 0;
+    TrackedNode* next = nullptr;
+};
+
+std::atomic<int> reclaimed{0};
+
+void reclaimTracked(HazardPointerObject* obj, void* /*ctx*/) {
+    delete static_cast<TrackedNode*>(obj);
+    reclaimed.fetch_add(1);
+}
+
+} // namespace
+
+TEST(HazardPointerTest, ProtectedObjectIsNotReclaimed) {
+    reclaimed.store(0);
+    {
+        HazardPointerDomain domain;
+        auto* node = new TrackedNode();
+        std::atomic<TrackedNode*> src{node};
+
+        HazardPointer hp(domain);
+        EXPECT_EQ(hp.protect(src), node);
+
+        // Unlink and retire while still protected
+        src.store(nullptr);
+        domain.retire(node, &reclaimTracked, nullptr);
+        domain.reclaim();
+        EXPECT_EQ(reclaimed.load(), 0);
+        EXPECT_EQ(domain.retiredCount(), 1u);
+
+        hp.reset();
+        domain.reclaim();
+        EXPECT_EQ(reclaimed.load(), 1);
+        EXPECT_EQ(domain.retiredCount(), 0u);
+    }
+}
+
+TEST(HazardPointerTest, DomainReclaimsLeftoversOnDestruction) {
+    reclaimed.store(0);
+    {
+        HazardPointerDomain domain;
+        for (int i = 0; i < 10; ++i) {
+            domain.retire(new TrackedNode(), &reclaimTracked, nullptr);
+        }
+    }
+    EXPECT_EQ(reclaimed.load(), 10);
+}
+
+TEST(HazardPointerTest, TreiberStackChurn) {
+    // Concurrent push/pop with immediate reuse of popped nodes: the pattern that
+    // crashes a plain Treiber stack with use-after-free / ABA
+    constexpr int threads = 4;
+    constexpr int iterations = 20000;
+
+    reclaimed.store(0);
+    std::atomic<int> created{0};
+    {
+        HazardPointerDomain domain;
+        std::atomic<TrackedNode*> head{nullptr};
+        std::atomic<long> sum{0};
+
+        auto push = [&](TrackedNode* node) {
+            TrackedNode* old = head.load(std::memory_order_relaxed);
+            do {
+                node->next = old;
+            } while (!head.compare_exchange_weak(old, node, std::memory_order_release, std::memory_order_relaxed));
+        };
+
+        std::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                HazardPointer hp(domain);
+                for (int i = 0; i < iterations; ++i) {
+                    auto* node = new TrackedNode();
+                    created.fetch_add(1);
+                    node->value = 1;
+                    push(node);
+
+                    TrackedNode* top = nullptr;
+                    while (true) {
+                        top = hp.protect(head);
+                        if (!top) break;
+                        if (head.compare_exchange_weak(top, top->next, std::memory_order_acq_rel)) break;
+                    }
+                    hp.reset();
+                    if (top) {
+                        sum.fetch_add(top->value);
+                        domain.retire(top, &reclaimTracked, nullptr);
+                    }
+                }
+            });
+        }
+        workers.clear();
+
+        // Every push is matched by a successful pop
+        EXPECT_EQ(sum.load(), static_cast<long>(threads) * iterations);
+        EXPECT_EQ(head.load(), nullptr);
+    }
+    EXPECT_EQ(reclaimed.load(), created.load());
+}
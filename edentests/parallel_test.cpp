@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "parallel.h"
+#include "threadpool.h"
+#include "models/hullwhite_1factor.h"
+
+#include <atomic>
+#include <cmath>
+#include <latch>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace eden;
+
+TEST(ParallelTest, ForVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    constexpr int n = 100000;
+    std::vector<std::atomic<int>> seen(n);
+
+    for (std::size_t grain : {kAutoGrain, std::size_t{1}, std::size_t{1000}, std::size_t{n * 2}}) {
+        for (auto& s : seen) s.store(0);
+        parallel_for(pool, 0, n, [&](int i) { seen[i].fetch_add(1, std::memory_order_relaxed); }, grain);
+        for (int i = 0; i < n; ++i) ASSERT_EQ(seen[i].load(), 1) << "grain " << grain << " index " << i;
+    }
+
+    // Empty and reversed ranges do nothing
+    parallel_for(pool, 5, 5, [&](int) { FAIL(); });
+    parallel_for(pool, 5, 1, [&](int) { FAIL(); });
+}
+
+TEST(ParallelTest, ReduceIsReproducible) {
+    ThreadPool pool(4);
+    std::vector<double> values(50000);
+    for (std::size_t i = 0; i < values.size(); ++i) values[i] = 1.0 / static_cast<double>(i + 1);
+
+    auto sum = [&] {
+        return parallel_reduce(pool, std::size_t{0}, values.size(), 0.0,
+            [&](std::size_t i) { return values[i]; },
+            [](double a, double b) { return a + b; },
+            256);
+    };
+
+    const double first = sum();
+    EXPECT_NEAR(first, std::accumulate(values.begin(), values.end(), 0.0), 1e-9);
+    // Same grain, same chunk order: bit for bit identical whatever the scheduling
+    for (int r = 0; r < 10; ++r) EXPECT_EQ(sum(), first);
+}
+
+TEST(ParallelTest, Transform) {
+    ThreadPool pool(3);
+    std::vector<int> in(1000);
+    std::iota(in.begin(), in.end(), 0);
+    std::vector<long> out(in.size());
+
+    auto end = parallel_transform(pool, in.begin(), in.end(), out.begin(), [](int x) { return 2L * x; });
+    EXPECT_EQ(end, out.end());
+    for (std::size_t i = 0; i < in.size(); ++i) EXPECT_EQ(out[i], 2L * in[i]);
+}
+
+TEST(ParallelTest, ExceptionReachesTheCaller) {
+    ThreadPool pool(4);
+    std::atomic<int> ran{0};
+    EXPECT_THROW(parallel_for(pool, 0, 10000, [&](int i) {
+        ran.fetch_add(1);
+        if (i == 1234) throw std::runtime_error("bad path");
+    }, 10), std::runtime_error);
+    // Chunks still queued after the failure are skipped
+    EXPECT_LE(ran.load(), 10000);
+
+    // The pool is still usable
+    std::atomic<int> sum{0};
+    parallel_for(pool, 0, 100, [&](int i) { sum.fetch_add(i); });
+    EXPECT_EQ(sum.load(), 4950);
+}
+
+TEST(ParallelTest, NestedInsideBusyPoolDoesNotDeadlock) {
+    // Every worker runs a job that itself calls parallel_for: helpers can never start,
+    // the callers must do all the chunks themselves
+    ThreadPool pool(2);
+    std::atomic<long> total{0};
+    std::latch done(2);
+    for (int j = 0; j < 2; ++j) {
+        pool.enqueue([&] {
+            parallel_for(pool, 0, 1000, [&](int i) { total.fetch_add(i); }, 10);
+            done.count_down();
+        });
+    }
+    done.wait();
+    EXPECT_EQ(total.load(), 2 * 499500L);
+}
+
+TEST(ParallelTest, HullWhitePathsDoNotDependOnThreadCount) {
+    std::vector<double> times = {0.5, 1.0, 2.0, 5.0};
+    std::vector<double> rates = {0.02, 0.022, 0.025, 0.03};
+    edenanalytics::HullWhiteModel1F model(0.1, 0.01, edenanalytics::YieldCurve(times, rates));
+
+    ThreadPool small(1);
+    ThreadPool large(4);
+    auto a = model.simulateShortRatePaths(small, 0.02, 0.01, 100, 64, 42);
+    auto b = model.simulateShortRatePaths(large, 0.02, 0.01, 100, 64, 42);
+
+    ASSERT_EQ(a.size(), 64u);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a[0][0], 0.02);
+    EXPECT_NE(a[0], a[1]);
+
+    // Seeds differing only in their high 32 bits give other paths
+    auto c = model.simulateShortRatePaths(small, 0.02, 0.01, 100, 64, 42 + (std::uint64_t{1} << 32));
+    EXPECT_NE(a, c);
+
+    EXPECT_THROW(model.simulateShortRatePaths(small, 0.02, 0.01, 0, 64, 42), std::invalid_argument);
+    EXPECT_THROW(model.simulateShortRatePaths(small, 0.02, 0.01, 100, -1, 42), std::invalid_argument);
+}
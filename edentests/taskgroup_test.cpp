@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "taskgroup.h"
+#include "threadpool.h"
+
+#include <atomic>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+
+using namespace eden;
+
+namespace {
+
+// Naive recursive Fibonacci: every level opens a group and waits on it from inside a job
+long fib(IThreadExecutor& executor, int n) {
+    if (n < 2) return n;
+    long a = 0;
+    TaskGroup group(executor);
+    group.run([&] { a = fib(executor, n - 1); });
+    const long b = fib(executor, n - 2);
+    group.wait();
+    return a + b;
+}
+
+} // namespace
+
+class TaskGroupModeTest : public ::testing::TestWithParam<SchedulingMode> {};
+
+INSTANTIATE_TEST_SUITE_P(AllModes, TaskGroupModeTest,
+    ::testing::Values(SchedulingMode::SharedStack, SchedulingMode::WorkStealing, SchedulingMode::Priority));
+
+TEST_P(TaskGroupModeTest, WaitsForNestedJobs) {
+    ThreadPool pool(3, GetParam());
+    std::atomic<int> count{0};
+    {
+        TaskGroup group(pool);
+        for (int i = 0; i < 100; ++i) {
+            group.run([&] {
+                count.fetch_add(1);
+                // Added while the group is running, still waited for
+                group.run([&] { count.fetch_add(1); });
+            });
+        }
+        group.wait();
+        EXPECT_EQ(count.load(), 200);
+        EXPECT_EQ(group.pending(), 0u);
+    }
+}
+
+TEST_P(TaskGroupModeTest, RecursionOnOneWorkerDoesNotDeadlock) {
+    // The single worker blocks in wait() at every level: only helping makes progress
+    ThreadPool pool(1, GetParam());
+    std::atomic<long> result{0};
+    std::latch done(1);
+    pool.enqueue([&] {
+        result = fib(pool, 18);
+        done.count_down();
+    });
+    done.wait();
+    EXPECT_EQ(result.load(), 2584);
+}
+
+TEST(TaskGroupTest, FirstExceptionIsRethrownAfterTheOthers) {
+    ThreadPool pool(2);
+    std::atomic<int> finished{0};
+    TaskGroup group(pool);
+    for (int i = 0; i < 50; ++i) {
+        group.run([&, i] {
+            if (i % 10 == 0) throw std::runtime_error("job failed");
+            finished.fetch_add(1);
+        });
+    }
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    // wait() returned only once every job was done
+    EXPECT_EQ(finished.load(), 45);
+    EXPECT_EQ(pool.stats().exceptions(), 0u);
+
+    // The error is reported once, the group can be reused
+    group.run([&] { finished.fetch_add(1); });
+    EXPECT_NO_THROW(group.wait());
+    EXPECT_EQ(finished.load(), 46);
+}
+
+TEST(TaskGroupTest, ExternalWaiterRunsJobsItself) {
+    // The only worker is held up: the group can only finish on the waiting thread
+    ThreadPool pool(1);
+    std::latch release(1);
+    pool.enqueue([&] { release.wait(); });
+
+    const auto caller = std::this_thread::get_id();
+    std::atomic<int> onCaller{0};
+    TaskGroup group(pool);
+    for (int i = 0; i < 10; ++i) {
+        group.run([&] {
+            if (std::this_thread::get_id() == caller) onCaller.fetch_add(1);
+        });
+    }
+    group.wait();
+    EXPECT_EQ(onCaller.load(), 10);
+    release.count_down();
+}
+
+TEST(TaskGroupTest, InlineExecutorNeverHelps) {
+    // An executor without a queue runs jobs on enqueue; wait() returns straight away
+    struct InlineExecutor : IThreadExecutor {
+        void enqueue(Job job) override { job(); }
+    } executor;
+
+    int count = 0;
+    TaskGroup group(executor);
+    for (int i = 0; i < 5; ++i) group.run([&] { ++count; });
+    EXPECT_EQ(group.pending(), 0u);
+    group.wait();
+    EXPECT_EQ(count, 5);
+}
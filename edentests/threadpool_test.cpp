@@ -0,0 +1,477 @@
+#include <gtest/gtest.h>
+#include "threadpool.h"
+#include "workstealingdeque.h"
+#include "mpmcqueue.h"
+#include "job.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace eden;
+
+TEST(WorkStealingDequeTest, OwnerLifoThiefFifo) {
+    WorkStealingDeque<int> deque(2);  // small capacity to force a grow
+
+    for (int i = 0; i < 10; ++i) {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.size(), 10);
+
+    // Thieves take the oldest element, the owner the newest
+    EXPECT_EQ(deque.steal().value(), 0);
+    EXPECT_EQ(deque.pop().value(), 9);
+    EXPECT_EQ(deque.steal().value(), 1);
+    EXPECT_EQ(deque.pop().value(), 8);
+
+    while (deque.pop()) {}
+    EXPECT_TRUE(deque.empty());
+    EXPECT_FALSE(deque.steal().has_value());
+}
+
+TEST(WorkStealingDequeTest, ConcurrentStealsSeeEachElementOnce) {
+    constexpr int total = 100000;
+    WorkStealingDeque<int> deque;
+    std::vector<std::atomic<int>> seen(total);
+    std::atomic<bool> producing{true};
+    std::atomic<int> taken{0};
+
+    std::vector<std::jthread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (producing.load() || !deque.empty()) {
+                if (auto x = deque.steal()) {
+                    seen[*x].fetch_add(1);
+                    taken.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < total; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            if (auto x = deque.pop()) {
+                seen[*x].fetch_add(1);
+                taken.fetch_add(1);
+            }
+        }
+    }
+    while (auto x = deque.pop()) {
+        seen[*x].fetch_add(1);
+        taken.fetch_add(1);
+    }
+    producing.store(false);
+    thieves.clear();
+
+    EXPECT_EQ(taken.load(), total);
+    for (int i = 0; i < total; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << "element " << i;
+    }
+}
+
+TEST(JobTest, SmallCapturesStayInline) {
+    const auto before = Job::heapAllocations();
+
+    int a = 0, b = 0, c = 0;
+    long id = 42;
+    Job job([&a, &b, &c, id] { a = b + c + static_cast<int>(id); });
+    Job moved = std::move(job);
+    EXPECT_FALSE(job);
+    moved();
+    EXPECT_EQ(a, 42);
+
+    EXPECT_EQ(Job::heapAllocations(), before);
+}
+
+TEST(JobTest, LargeAndMoveOnlyCaptures) {
+    const auto before = Job::heapAllocations();
+
+    std::array<double, 32> big{};
+    big[31] = 1.5;
+    double out = 0.0;
+    Job large([big, &out] { out = big[31]; });
+    EXPECT_EQ(Job::heapAllocations(), before + 1);
+    large();
+    EXPECT_EQ(out, 1.5);
+
+    auto owned = std::make_unique<int>(7);
+    int seen = 0;
+    Job moveOnly([p = std::move(owned), &seen] { seen = *p; });
+    moveOnly();
+    EXPECT_EQ(seen, 7);
+    moveOnly.reset();
+    EXPECT_FALSE(moveOnly);
+}
+
+namespace {
+
+struct QueueNode : HazardPointerObject {
+    int value = 0;
+    std::atomic<QueueNode*> link{nullptr};
+};
+
+void deleteQueueNode(HazardPointerObject* obj, void* /*ctx*/) {
+    delete static_cast<QueueNode*>(obj);
+}
+
+} // namespace
+
+TEST(IntrusiveMpmcQueueTest, ProducersKeepTheirOrder) {
+    constexpr int producers = 3;
+    constexpr int perProducer = 20000;
+
+    HazardPointerDomain domain;
+    IntrusiveMpmcQueue<QueueNode, &QueueNode::link> queue(new QueueNode());
+    std::atomic<int> popped{0};
+    std::atomic<bool> ordered{true};
+    // Last value seen per producer, by consumer; values are producer * perProducer + seq
+    std::vector<std::array<int, producers>> last(2);
+    for (auto& l : last) l.fill(-1);
+
+    {
+        std::vector<std::jthread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                HazardPointer hp(domain);
+                for (int i = 0; i < perProducer; ++i) {
+                    auto* node = new QueueNode();
+                    node->value = p * perProducer + i;
+                    queue.push(node, hp);
+                }
+            });
+        }
+        for (int c = 0; c < 2; ++c) {
+            threads.emplace_back([&, c] {
+                HazardPointer hp(domain);
+                HazardPointer hpNext(domain);
+                while (popped.load() < producers * perProducer) {
+                    auto [node, retired] = queue.pop(hp, hpNext);
+                    if (!node) continue;
+                    const int value = node->value;
+                    hpNext.reset();
+                    domain.retire(retired, &deleteQueueNode, nullptr);
+
+                    // FIFO per producer, as seen by any single consumer
+                    int& prev = last[c][value / perProducer];
+                    if (value <= prev) ordered.store(false);
+                    prev = value;
+                    popped.fetch_add(1);
+                }
+            });
+        }
+    }
+
+    EXPECT_TRUE(ordered.load());
+    EXPECT_EQ(popped.load(), producers * perProducer);
+    EXPECT_TRUE(queue.empty());
+    delete queue.dummy();
+}
+
+class ThreadPoolModeTest : public ::testing::TestWithParam<SchedulingMode> {};
+
+TEST_P(ThreadPoolModeTest, RunsEveryJob) {
+    constexpr int jobs = 10000;
+    std::atomic<int> counter{0};
+    std::latch done(jobs);
+    {
+        ThreadPool pool(4, GetParam());
+        for (int i = 0; i < jobs; ++i) {
+            pool.enqueue([&] {
+                counter.fetch_add(1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+    EXPECT_EQ(counter.load(), jobs);
+}
+
+TEST_P(ThreadPoolModeTest, NestedEnqueueFromWorkers) {
+    // Binary fan-out tree spawned from inside the workers
+    constexpr int depth = 12;
+    constexpr int nodes = (1 << (depth + 1)) - 1;
+    std::atomic<int> counter{0};
+    std::latch done(nodes);
+
+    ThreadPool pool(4, GetParam());
+    std::function<void(int)> spawn = [&](int level) {
+        pool.enqueue([&, level] {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            if (level < depth) {
+                spawn(level + 1);
+                spawn(level + 1);
+            }
+            done.count_down();
+        });
+    };
+    spawn(0);
+    done.wait();
+
+    EXPECT_EQ(counter.load(), nodes);
+}
+
+TEST_P(ThreadPoolModeTest, BulkEnqueueRunsEveryJob) {
+    constexpr int batches = 50;
+    constexpr int perBatch = 200;
+    std::atomic<int> counter{0};
+    std::latch done(batches * perBatch * 2);
+
+    ThreadPool pool(4, GetParam());
+    auto makeBatch = [&] {
+        std::vector<Job> jobs;
+        for (int i = 0; i < perBatch; ++i) {
+            jobs.emplace_back([&] {
+                counter.fetch_add(1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+        return jobs;
+    };
+
+    for (int b = 0; b < batches; ++b) {
+        // From outside the pool
+        auto jobs = makeBatch();
+        pool.enqueueBulk(jobs);
+        // And from a worker, as a finishing workflow task does
+        pool.enqueue([&] {
+            auto nested = makeBatch();
+            pool.enqueueBulk(nested, JobPriority::High);
+        });
+    }
+    done.wait();
+
+    EXPECT_EQ(counter.load(), batches * perBatch * 2);
+}
+
+TEST_P(ThreadPoolModeTest, ShutdownWithPendingJobs) {
+    std::atomic<int> counter{0};
+    {
+        ThreadPool pool(1, GetParam());
+        for (int i = 0; i < 1000; ++i) {
+            pool.enqueue([&] { counter.fetch_add(1); });
+        }
+        // Destructor must not hang nor leak the jobs left in the queues
+    }
+    EXPECT_LE(counter.load(), 1000);
+}
+
+TEST_P(ThreadPoolModeTest, SteadyStateSubmissionDoesNotAllocate) {
+    constexpr int warmupRounds = 10;
+    constexpr int rounds = 20;
+    constexpr int jobs = 2000;
+    ThreadPool pool(4, GetParam());
+
+    auto runRound = [&pool] {
+        // Same shape as Workflow::run: a few references plus an id
+        std::latch done(jobs);
+        std::atomic<int> counter{0};
+        for (int i = 0; i < jobs; ++i) {
+            pool.enqueue([&done, &counter, i] {
+                counter.fetch_add(i & 1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+        done.wait();
+    };
+
+    // Let the node pool grow to the peak queue depth first
+    for (int r = 0; r < warmupRounds; ++r) runRound();
+    const auto warmNodes = pool.allocationCount();
+    const auto jobAllocations = Job::heapAllocations();
+
+    for (int r = 0; r < rounds; ++r) runRound();
+
+    // The high-water mark may still creep up: how far the producer runs ahead of the
+    // workers, how many idle nodes sit in worker caches and how many wait in the hazard
+    // pointer retired list (which keeps growing while a scanning worker is descheduled)
+    // all vary from round to round. Allocating per submission would add one node per job.
+    EXPECT_GT(warmNodes, 0u);
+    EXPECT_LT(pool.allocationCount() - warmNodes, static_cast<std::uint64_t>(rounds * jobs / 10));
+    EXPECT_EQ(Job::heapAllocations(), jobAllocations);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Modes, ThreadPoolModeTest,
+    ::testing::Values(SchedulingMode::SharedStack, SchedulingMode::WorkStealing, SchedulingMode::Priority));
+
+TEST(ThreadPoolPriorityTest, HigherLevelsFirstFifoWithinALevel) {
+    ThreadPool pool(1, SchedulingMode::Priority);
+
+    // Park the only worker so every job below is queued before any runs
+    std::latch started(1);
+    std::latch release(1);
+    pool.enqueue([&] {
+        started.count_down();
+        release.wait();
+    });
+    started.wait();
+
+    std::mutex mutex;
+    std::vector<int> order;
+    constexpr int perLevel = 5;
+    std::latch done(perLevel * 4);
+    for (int i = 0; i < perLevel; ++i) {
+        for (auto priority : {JobPriority::Low, JobPriority::Normal, JobPriority::High, JobPriority::Critical}) {
+            // Encodes the level in the tens and the submission rank in the units
+            const int tag = static_cast<int>(priority) * 10 + i;
+            pool.enqueue([&, tag] {
+                std::lock_guard lock(mutex);
+                order.push_back(tag);
+                done.count_down();
+            }, priority);
+        }
+    }
+    release.count_down();
+    done.wait();
+
+    std::vector<int> expected;
+    for (int level = 3; level >= 0; --level) {
+        for (int i = 0; i < perLevel; ++i) expected.push_back(level * 10 + i);
+    }
+    EXPECT_EQ(order, expected);
+}
+
+TEST(LatencyHistogramTest, BucketsAndQuantiles) {
+    EXPECT_EQ(LatencyHistogram::bucketFor(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(1), 1u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(1000), 10u);  // [512, 1024)
+    EXPECT_EQ(LatencyHistogram::bucketFor(~0ull), LatencyHistogram::kBuckets - 1);
+
+    LatencyHistogram h;
+    EXPECT_EQ(h.quantileNs(0.5), 0u);
+    h.counts[LatencyHistogram::bucketFor(100)] = 99;
+    h.counts[LatencyHistogram::bucketFor(100000)] = 1;
+    EXPECT_EQ(h.total(), 100u);
+    EXPECT_EQ(h.quantileNs(0.5), 128u);
+    EXPECT_EQ(h.quantileNs(1.0), 131072u);
+}
+
+TEST(ThreadPoolStatsTest, CountsJobsExceptionsAndWaits) {
+    constexpr int jobs = 1000;
+    constexpr int failing = 10;
+    ThreadPool pool(2);
+
+    std::latch done(jobs);
+    for (int i = 0; i < jobs; ++i) {
+        pool.enqueue([&, i] {
+            done.count_down();
+            if (i < failing) throw std::runtime_error("job failed");
+        });
+    }
+    done.wait();
+
+    // Counters are bumped after the job returns: wait for the last ones
+    ExecutorStats stats = pool.stats();
+    for (int spin = 0; spin < 10000 && stats.jobs() < jobs; ++spin) {
+        std::this_thread::yield();
+        stats = pool.stats();
+    }
+
+    ASSERT_EQ(stats.workers.size(), 2u);
+    EXPECT_EQ(stats.jobs(), static_cast<std::uint64_t>(jobs));
+    EXPECT_EQ(stats.exceptions(), static_cast<std::uint64_t>(failing));
+    EXPECT_EQ(stats.queued, 0);
+    // Sampled, about one job in 16
+    EXPECT_GT(stats.queueWait().total(), 0u);
+    EXPECT_LT(stats.queueWait().total(), static_cast<std::uint64_t>(jobs));
+    EXPECT_GE(stats.utilisation(), 0.0);
+    EXPECT_LE(stats.utilisation(), 1.0);
+}
+
+namespace {
+
+// Poll until pred() holds, for at most the timeout
+template <class Pred>
+bool eventually(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(ThreadPoolElasticTest, GrowsUnderBacklogAndShrinksWhenIdle) {
+    ElasticLimits limits;
+    limits.minWorkers = 1;
+    limits.maxWorkers = 4;
+    limits.spawnAfterWait = std::chrono::microseconds(200);
+    limits.retireAfterIdle = std::chrono::milliseconds(50);
+
+    ThreadPool pool(limits);
+    EXPECT_TRUE(pool.elastic());
+    EXPECT_EQ(pool.size(), 1u);
+
+    // Slow jobs pile up behind the single worker, their queue wait triggers growth
+    std::atomic<int> done{0};
+    std::atomic<std::size_t> peak{0};
+    constexpr int jobs = 40;
+    for (int i = 0; i < jobs; ++i) {
+        pool.enqueue([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            std::size_t seen = peak.load();
+            while (seen < pool.size() && !peak.compare_exchange_weak(seen, pool.size())) {}
+            done.fetch_add(1);
+        });
+    }
+    ASSERT_TRUE(eventually([&] { return done.load() == jobs; }));
+    EXPECT_GT(peak.load(), 1u);
+    EXPECT_LE(peak.load(), 4u);
+
+    // Back to the minimum once the extra workers have idled long enough
+    EXPECT_TRUE(eventually([&] { return pool.size() == 1; }));
+    EXPECT_EQ(pool.stats().workers.size(), 4u);
+    EXPECT_EQ(pool.stats().jobs(), static_cast<std::uint64_t>(jobs));
+
+    // Retired slots are reused for the next peak
+    done = 0;
+    for (int i = 0; i < jobs; ++i) {
+        pool.enqueue([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            done.fetch_add(1);
+        });
+    }
+    ASSERT_TRUE(eventually([&] { return done.load() == jobs; }));
+}
+
+TEST(ThreadPoolElasticTest, ShutdownStopsSurplusWorkers) {
+    ElasticLimits limits;
+    limits.minWorkers = 1;
+    limits.maxWorkers = 3;
+    limits.spawnAfterWait = std::chrono::microseconds(100);
+    limits.retireAfterIdle = std::chrono::minutes(1);
+
+    std::atomic<int> done{0};
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(limits, SchedulingMode::WorkStealing);
+        for (int i = 0; i < 20; ++i) {
+            pool.enqueue([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                done.fetch_add(1);
+            });
+        }
+        ASSERT_TRUE(eventually([&] { return done.load() == 20; }));
+    }
+    // Surplus workers poll the stop token, they do not wait out retireAfterIdle
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
+
+TEST(ThreadPoolElasticTest, RejectsInvalidLimits) {
+    ElasticLimits limits;
+    limits.minWorkers = 0;
+    EXPECT_THROW(ThreadPool{limits}, std::invalid_argument);
+    limits.minWorkers = 4;
+    limits.maxWorkers = 2;
+    EXPECT_THROW(ThreadPool{limits}, std::invalid_argument);
+}
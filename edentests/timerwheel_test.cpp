@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "timerwheel.h"
+#include "threadpool.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <latch>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace eden;
+using namespace std::chrono_literals;
+
+TEST(TimerWheelTest, OneShotRunsAfterItsDelay) {
+    ThreadPool pool(2);
+    std::latch fired(1);
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration elapsed{};
+
+    pool.enqueueAfter(20ms, [&] {
+        elapsed = std::chrono::steady_clock::now() - start;
+        fired.count_down();
+    });
+    fired.wait();
+    EXPECT_GE(elapsed, 20ms);
+    EXPECT_LT(elapsed, 2s);
+}
+
+TEST(TimerWheelTest, FiresInDeadlineOrderAcrossLevels) {
+    // 10us ticks: the longer delays sit two levels up and must be cascaded down in time
+    ThreadPool pool(1);
+    TimerWheel wheel(pool, 10us);
+    std::mutex mutex;
+    std::vector<int> order;
+    std::latch fired(6);
+
+    const std::chrono::milliseconds delays[] = {60ms, 1ms, 45ms, 15ms, 5ms, 30ms};
+    for (auto delay : delays) {
+        wheel.after(delay, [&, ms = static_cast<int>(delay.count())] {
+            std::lock_guard lock(mutex);
+            order.push_back(ms);
+            fired.count_down();
+        });
+    }
+    EXPECT_EQ(wheel.pending(), 6u);
+    fired.wait();
+    EXPECT_EQ(order, (std::vector<int>{1, 5, 15, 30, 45, 60}));
+    EXPECT_EQ(wheel.pending(), 0u);
+}
+
+TEST(TimerWheelTest, PeriodicUntilCancelled) {
+    ThreadPool pool(2);
+    std::atomic<int> runs{0};
+    const TimerId id = pool.enqueueEvery(2ms, [&] { runs.fetch_add(1); });
+
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (runs.load() < 5 && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(1ms);
+    EXPECT_GE(runs.load(), 5);
+
+    EXPECT_TRUE(pool.cancelTimer(id));
+    EXPECT_FALSE(pool.cancelTimer(id));
+    // At most a run already handed to the pool completes after the cancel
+    std::this_thread::sleep_for(10ms);
+    const int after = runs.load();
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(runs.load(), after);
+}
+
+TEST(TimerWheelTest, SlowPeriodicJobIsNotQueuedTwice) {
+    ThreadPool pool(4);
+    std::atomic<int> running{0};
+    std::atomic<int> overlap{0};
+    std::atomic<int> runs{0};
+    const TimerId id = pool.enqueueEvery(1ms, [&] {
+        if (running.fetch_add(1) > 0) overlap.fetch_add(1);
+        std::this_thread::sleep_for(5ms);
+        running.fetch_sub(1);
+        runs.fetch_add(1);
+    });
+    std::this_thread::sleep_for(50ms);
+    pool.cancelTimer(id);
+    std::this_thread::sleep_for(10ms);
+    EXPECT_GT(runs.load(), 0);
+    EXPECT_EQ(overlap.load(), 0);
+}
+
+TEST(TimerWheelTest, CancelledOneShotNeverRuns) {
+    ThreadPool pool(1);
+    std::atomic<bool> ran{false};
+    const TimerId id = pool.enqueueAfter(20ms, [&] { ran = true; });
+    EXPECT_TRUE(pool.cancelTimer(id));
+    std::this_thread::sleep_for(40ms);
+    EXPECT_FALSE(ran.load());
+    EXPECT_FALSE(pool.cancelTimer(12345));
+}
+
+TEST(TimerWheelTest, ThousandsOfPendingTimersCostNoCpu) {
+    ThreadPool pool(1);
+    TimerWheel wheel(pool);
+    for (int i = 0; i < 10000; ++i) {
+        // Spread over a day: every level of the wheel, and beyond it
+        wheel.after(std::chrono::seconds(1 + i * 9), [] {});
+    }
+    EXPECT_EQ(wheel.pending(), 10000u);
+
+    const std::clock_t cpuBefore = std::clock();
+    std::this_thread::sleep_for(200ms);
+    const double cpuMs = 1000.0 * static_cast<double>(std::clock() - cpuBefore) / CLOCKS_PER_SEC;
+    // A timer thread waking every tick would spend far more than this
+    EXPECT_LT(cpuMs, 20.0);
+}
+
+TEST(TimerWheelTest, ExecutorsWithoutTimersSayNo) {
+    struct InlineExecutor : IThreadExecutor {
+        void enqueue(Job job) override { job(); }
+    } executor;
+    EXPECT_THROW(executor.enqueueAfter(1ms, [] {}), std::logic_error);
+    EXPECT_THROW(executor.enqueueEvery(1ms, [] {}), std::logic_error);
+    EXPECT_FALSE(executor.cancelTimer(1));
+}
+
+TEST(TimerWheelTest, ArmingATimerDuringPoolDestructionIsRefused) {
+    std::atomic<int> armed{0};
+    std::atomic<bool> refused{false};
+    {
+        ThreadPool pool(1);
+        std::latch started(1);
+        // Still running when the destructor closes the timer wheel
+        pool.enqueue([&] {
+            started.count_down();
+            while (pool.enqueueAfter(1ms, [] {}) != 0) armed.fetch_add(1);
+            refused = true;
+        });
+        started.wait();
+        while (armed.load() == 0) std::this_thread::yield();
+    }
+    EXPECT_TRUE(refused.load());
+    EXPECT_GT(armed.load(), 0);
+}
@@ -1,12 +1,20 @@
 #include <gtest/gtest.h>
 #include "workflow/workflow.h"
 #include "workflow/workflowserializer.h"
+#include "workflow/resultcache.h"
 #include "task/fetchdatatask.h"
+#include "task/scenariotask.h"
 #include "attributes.h"
 #include "context.h"
 #include "datetime.h"
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
 
 TEST(WorkflowTest, AddAndRetrieveTask) {
     auto cob = eden::DateTime(2024, 6, 3);
@@ -86,3 +94,1378 @@ TEST(WorkflowTest, SaveAndLoadJson) {
 
     std::filesystem::remove(path);  // clean up
 }
+
+TEST(WorkflowTest, LoadRejectsAnOutOfRangePriority) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+    auto wfSerialiser = std::make_unique<eden::WorkflowSerializer>();
+    std::string path = "test_workflow_priority.json";
+
+    for (int priority : {-1, 7}) {
+        {
+            std::ofstream out(path);
+            out << R"({"workflow": "Flow", "tasks": [{"id": 1, "name": "TaskA", "type": "FetchDataTask",)"
+                << R"( "status": "Pending", "input_id": 0, "output_id": 0, "priority": )" << priority
+                << R"(}], "deps": [], "node_links": []})";
+        }
+        auto loaded = std::make_unique<eden::Workflow>("EmptyFlow", attr, ctx);
+        EXPECT_THROW(wfSerialiser->load(loaded, path), std::runtime_error);
+    }
+
+    std::filesystem::remove(path);
+}
+
+namespace {
+
+// Runs every job inline and records how it was submitted
+struct RecordingExecutor : eden::IThreadExecutor {
+    int singles = 0;
+    std::vector<std::size_t> batches;
+
+    void enqueue(eden::Job job) override {
+        ++singles;
+        job();
+    }
+
+    void enqueueBulk(std::span<eden::Job> jobs, eden::JobPriority /*priority*/) override {
+        batches.push_back(jobs.size());
+        for (auto& job : jobs) job();
+    }
+};
+
+} // namespace
+
+TEST(WorkflowTest, FanOutIsScheduledAsOneBatch) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    auto wf = std::make_unique<eden::Workflow>("FanOut", attr, ctx);
+    constexpr int children = 50;
+    wf->addTask(0, std::make_shared<eden::FetchDataTask>(0, "Root", 0, 0));
+    for (int i = 1; i <= children; ++i) {
+        wf->addTask(i, std::make_shared<eden::FetchDataTask>(i, "Child", 0, 0));
+        wf->dependsOn(i, 0);
+    }
+
+    RecordingExecutor executor;
+    wf->run(executor);
+
+    // The root alone, then every child released by it in a single call
+    EXPECT_EQ(executor.singles, 1);
+    ASSERT_EQ(executor.batches.size(), 1u);
+    EXPECT_EQ(executor.batches[0], static_cast<std::size_t>(children));
+}
+
+namespace {
+
+struct ThrowingTask : eden::ITask {
+    using eden::ITask::ITask;
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override { throw std::runtime_error("task failed"); }
+};
+
+struct CountingTask : eden::ITask {
+    CountingTask(eden::TaskID id, std::atomic<int>& runs, int inputID = 0, int outputID = 0)
+        : eden::ITask(id, "Counting", inputID, outputID), runs_(runs) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override { runs_.fetch_add(1); }
+    std::atomic<int>& runs_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, TaskExceptionStopsDependentsAndReachesRun) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    auto wf = std::make_unique<eden::Workflow>("Failing", attr, ctx);
+    std::atomic<int> runs{0};
+    wf->addTask(1, std::make_shared<CountingTask>(1, runs));
+    wf->addTask(2, std::make_shared<ThrowingTask>(2, "Broken", 0, 0));
+    wf->addTask(3, std::make_shared<CountingTask>(3, runs));
+    wf->dependsOn(2, 1);
+    wf->dependsOn(3, 2);
+
+    eden::ThreadPool pool(2);
+    EXPECT_THROW(wf->run(pool), std::runtime_error);
+    // Only the task before the failure ran
+    EXPECT_EQ(runs.load(), 1);
+}
+
+TEST(ExecutionPlanTest, DenseIndicesCsrAndTransitiveReduction) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    // 10 -> 20 -> 30, plus the redundant 10 -> 30 and a duplicated 20 -> 30
+    eden::Workflow wf("Plan", attr, ctx);
+    for (int id : {30, 20, 10, 40}) wf.addTask(id, std::make_shared<eden::FetchDataTask>(id, "T", 0, 0));
+    wf.dependsOn(20, 10);
+    wf.dependsOn(30, 20);
+    wf.dependsOn(30, 10);
+    wf.dependsOn(30, 20);
+
+    const auto compiled = wf.compile();
+    const auto& plan = *compiled;
+    ASSERT_EQ(plan.size(), 4u);
+    EXPECT_EQ(plan.edgeCount(), 2u);
+    EXPECT_EQ(plan.removedEdges(), 2u);
+
+    const auto i10 = plan.indexOf(10);
+    const auto i20 = plan.indexOf(20);
+    const auto i30 = plan.indexOf(30);
+    // Topological indices
+    EXPECT_LT(i10, i20);
+    EXPECT_LT(i20, i30);
+    EXPECT_EQ(plan.idOf(i30), 30);
+
+    ASSERT_EQ(plan.children(i10).size(), 1u);
+    EXPECT_EQ(plan.children(i10)[0], i20);
+    EXPECT_EQ(plan.inDegree(i30), 1u);
+    EXPECT_EQ(plan.roots().size(), 2u);  // 10 and 40
+
+    // Cached until the graph changes
+    EXPECT_EQ(wf.compile(), compiled);
+    wf.dependsOn(40, 30);
+    EXPECT_EQ(wf.compile()->edgeCount(), 3u);
+    // The old plan is still held, unchanged
+    EXPECT_EQ(plan.edgeCount(), 2u);
+}
+
+TEST(ExecutionPlanTest, RejectsCyclesAndUnknownTasks) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    eden::Workflow cyclic("Cycle", attr, ctx);
+    for (int id : {1, 2, 3}) cyclic.addTask(id, std::make_shared<eden::FetchDataTask>(id, "T", 0, 0));
+    cyclic.dependsOn(2, 1);
+    cyclic.dependsOn(3, 2);
+    cyclic.dependsOn(1, 3);
+    EXPECT_THROW(cyclic.compile(), std::runtime_error);
+
+    eden::Workflow unknown("Unknown", attr, ctx);
+    unknown.addTask(1, std::make_shared<eden::FetchDataTask>(1, "T", 0, 0));
+    unknown.dependsOn(1, 99);
+    EXPECT_THROW(unknown.compile(), std::runtime_error);
+}
+
+TEST(ExecutionPlanTest, PlanIsReusedAcrossRuns) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    // Diamond lattice: every task of a layer depends on every task of the previous one
+    eden::Workflow wf("Lattice", attr, ctx);
+    std::atomic<int> runs{0};
+    constexpr int layers = 5;
+    constexpr int width = 8;
+    for (int l = 0; l < layers; ++l) {
+        for (int w = 0; w < width; ++w) {
+            const int id = l * width + w;
+            wf.addTask(id, std::make_shared<CountingTask>(id, runs));
+            if (l == 0) continue;
+            for (int p = 0; p < width; ++p) wf.dependsOn(id, (l - 1) * width + p);
+        }
+    }
+
+    eden::ThreadPool pool(4);
+    const auto plan = wf.compile();
+    for (int r = 1; r <= 3; ++r) {
+        wf.run(pool);
+        EXPECT_EQ(runs.load(), r * layers * width);
+    }
+    EXPECT_EQ(wf.compile(), plan);
+}
+
+namespace {
+
+struct OrderTask : eden::ITask {
+    OrderTask(eden::TaskID id, const std::string& name, std::vector<eden::TaskID>& order)
+        : eden::ITask(id, name, 0, 0), order_(order) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override { order_.push_back(ID()); }
+    std::vector<eden::TaskID>& order_;
+};
+
+// Two task types for the duration history, whatever the instance names
+struct QuickTask : OrderTask {
+    using OrderTask::OrderTask;
+};
+struct CalibrateTask : OrderTask {
+    using OrderTask::OrderTask;
+};
+
+} // namespace
+
+TEST(DurationHistoryTest, SmoothedMeanAndRoundTrip) {
+    using namespace std::chrono_literals;
+    eden::DurationHistory history(0.5);
+    EXPECT_FALSE(history.estimate("Calibrate").has_value());
+
+    history.record("Calibrate", 100ms);
+    EXPECT_EQ(*history.estimate("Calibrate"), 100ms);
+    history.record("Calibrate", 200ms);
+    EXPECT_EQ(*history.estimate("Calibrate"), 150ms);
+    history.record("Fetch", 2ms);
+
+    const std::string path = "test_durations.json";
+    history.save(path);
+    eden::DurationHistory loaded;
+    loaded.load(path);
+    EXPECT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded.samples("Calibrate"), 2u);
+    EXPECT_EQ(*loaded.estimate("Fetch"), 2ms);
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(eden::DurationHistory(0.0), std::invalid_argument);
+}
+
+TEST(WorkflowTest, LongestRemainingPathRunsFirst) {
+    using namespace std::chrono_literals;
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    // Four quick independent tasks, and a chain of three slow ones with the highest id
+    std::vector<eden::TaskID> order;
+    eden::Workflow wf("CriticalPath", attr, ctx);
+    for (int id = 1; id <= 4; ++id) {
+        wf.addTask(id, std::make_shared<QuickTask>(id, "Quick" + std::to_string(id), order));
+    }
+    for (int id = 10; id <= 12; ++id) {
+        wf.addTask(id, std::make_shared<CalibrateTask>(id, "Calibrate" + std::to_string(id), order));
+    }
+    wf.dependsOn(11, 10);
+    wf.dependsOn(12, 11);
+
+    // Keyed by type: each instance gets its type's estimate
+    const auto quick = eden::DurationHistory::typeOf(*wf.tasks().at(1));
+    const auto calibrate = eden::DurationHistory::typeOf(*wf.tasks().at(10));
+    EXPECT_NE(quick, calibrate);
+    EXPECT_NE(quick.find("QuickTask"), std::string::npos);
+    auto history = std::make_shared<eden::DurationHistory>();
+    history->record(quick, 1ms);
+    history->record(calibrate, 50ms);
+    wf.setDurationHistory(history);
+
+    RecordingExecutor executor;
+    wf.run(executor);
+
+    EXPECT_EQ(order, (std::vector<eden::TaskID>{10, 11, 12, 1, 2, 3, 4}));
+
+    const auto& report = wf.lastReport();
+    EXPECT_EQ(report.criticalPath, 150ms);
+    EXPECT_EQ(report.totalWork, 154ms);
+    EXPECT_EQ(report.predicted, 154ms);  // one worker
+    EXPECT_EQ(report.criticalTasks, (std::vector<eden::TaskID>{10, 11, 12}));
+    EXPECT_GT(report.actual.count(), 0);
+
+    // Every run feeds the history
+    EXPECT_EQ(history->samples(calibrate), 4u);
+    EXPECT_EQ(history->samples(quick), 5u);
+    EXPECT_EQ(history->size(), 2u);
+}
+
+TEST(WorkflowTest, CriticalPathSchedulingOnThreadPool) {
+    auto cob = eden::DateTime(2024, 6, 3);
+    const eden::AttributeSPtr& attr = std::make_shared<eden::Attributes>(cob);
+    const eden::ContextSPtr& ctx = std::make_shared<eden::TaskContext>();
+
+    eden::Workflow wf("Lattice", attr, ctx);
+    std::atomic<int> runs{0};
+    for (int l = 0; l < 4; ++l) {
+        for (int w = 0; w < 6; ++w) {
+            const int id = l * 6 + w;
+            wf.addTask(id, std::make_shared<CountingTask>(id, runs));
+            if (l > 0) wf.dependsOn(id, (l - 1) * 6 + (w + l) % 6);
+        }
+    }
+    wf.setDurationHistory(std::make_shared<eden::DurationHistory>());
+
+    eden::ThreadPool pool(4);
+    wf.run(pool);
+    wf.run(pool);
+    EXPECT_EQ(runs.load(), 48);
+    EXPECT_EQ(wf.lastReport().workers, pool.concurrency());
+    EXPECT_EQ(wf.lastReport().criticalTasks.size(), 4u);
+}
+
+namespace {
+
+struct TallyTask : eden::ITask {
+    TallyTask(eden::TaskID id, std::vector<std::string> keys, std::array<std::atomic<int>, 8>& runs)
+        : eden::ITask(id, "Tally", 0, 0), runs_(runs) { setContextKeys(std::move(keys)); }
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override { runs_[ID()].fetch_add(1); }
+    std::array<std::atomic<int>, 8>& runs_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, IncrementalRunOnlyRerunsChangedTasksAndDescendants) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    auto ctx = std::make_shared<eden::JsonContext>();
+    ctx->set("fx", 1.08);
+    ctx->set("rates", 0.03);
+
+    // 1 (reads fx) -> 2 -> 5 <- 4 <- 3 (reads rates)
+    std::array<std::atomic<int>, 8> runs{};
+    eden::Workflow wf("Intraday", attr, ctx);
+    wf.addTask(1, std::make_shared<TallyTask>(1, std::vector<std::string>{"fx"}, runs));
+    wf.addTask(2, std::make_shared<TallyTask>(2, std::vector<std::string>{}, runs));
+    wf.addTask(3, std::make_shared<TallyTask>(3, std::vector<std::string>{"rates"}, runs));
+    wf.addTask(4, std::make_shared<TallyTask>(4, std::vector<std::string>{"rates"}, runs));
+    wf.addTask(5, std::make_shared<TallyTask>(5, std::vector<std::string>{"rates"}, runs));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(4, 3);
+    wf.dependsOn(5, 2);
+    wf.dependsOn(5, 4);
+    wf.setIncremental(true);
+
+    const auto counts = [&] {
+        std::vector<int> out;
+        for (int id = 1; id <= 5; ++id) out.push_back(runs[id].load());
+        return out;
+    };
+
+    eden::ThreadPool pool(2);
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{1, 1, 1, 1, 1}));
+
+    // Nothing changed
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{1, 1, 1, 1, 1}));
+
+    // Task 2 reads the whole context, so any change reaches it; 3 and 4 read the rates
+    ctx->set("rates", 0.031);
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{1, 2, 2, 2, 2}));
+
+    // Explicit invalidation reruns the task and what depends on it
+    wf.invalidate(3);
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{1, 2, 3, 3, 3}));
+
+    // A new COB changes every fingerprint
+    wf.setAttributes(std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 4)));
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{2, 3, 4, 4, 4}));
+
+    // Full runs are still available
+    wf.setIncremental(false);
+    wf.run(pool);
+    EXPECT_EQ(counts(), (std::vector<int>{3, 4, 5, 5, 5}));
+}
+
+TEST(WorkflowTest, ContextFingerprintIsSafeToReadConcurrently) {
+    eden::JsonContext ctx;
+    ctx.set("curve", 1);
+    const auto before = ctx.fingerprint({});
+
+    // Concurrent runs ask for it at the same time
+    std::vector<eden::Fingerprint> seen(8);
+    {
+        std::vector<std::jthread> readers;
+        for (auto& value : seen) readers.emplace_back([&ctx, &value] { value = ctx.fingerprint({}); });
+    }
+    for (auto value : seen) EXPECT_EQ(value, before);
+
+    ctx.set("curve", 2);
+    EXPECT_NE(ctx.fingerprint({}), before);
+    ctx.set("curve", 1);
+    EXPECT_EQ(ctx.fingerprint({}), before);
+}
+
+TEST(WorkflowTest, IncrementalRunRetriesTasksThatDidNotComplete) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<int> runs{0};
+    eden::Workflow wf("Retry", attr, ctx);
+    wf.addTask(1, std::make_shared<CountingTask>(1, runs));
+    wf.addTask(2, std::make_shared<ThrowingTask>(2, "Broken", 0, 0));
+    wf.addTask(3, std::make_shared<CountingTask>(3, runs));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 2);
+    wf.setIncremental(true);
+
+    eden::ThreadPool pool(2);
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_EQ(runs.load(), 1);
+
+    // Task 1 completed and is skipped, the failed task runs (and fails) again
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_EQ(runs.load(), 1);
+}
+
+TEST(HashTest, FingerprintsAreStableAndOrderSensitive) {
+    using eden::Hasher;
+    EXPECT_EQ(Hasher().add("ab").add("c").value(), Hasher().add("ab").add("c").value());
+    EXPECT_NE(Hasher().add("ab").add("c").value(), Hasher().add("a").add("bc").value());
+    EXPECT_NE(Hasher().add(1).add(2).value(), Hasher().add(2).add(1).value());
+    EXPECT_EQ(Hasher().add(0.0).value(), Hasher().add(-0.0).value());
+    // Fixed algorithm: fingerprints can be stored and compared across processes
+    EXPECT_EQ(Hasher().value(), 0xcbf29ce484222325ull);
+    EXPECT_EQ(Hasher().bytes("a", 1).value(), 0xaf63dc4c8601ec8cull);
+}
+
+namespace {
+
+// Doubles the COB day; the result can be cached
+struct CachedTask : eden::ITask {
+    CachedTask(eden::TaskID id, std::atomic<int>& runs) : eden::ITask(id, "Cached", 0, 0), runs_(runs) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr& attrs, const eden::ContextSPtr&) override {
+        runs_.fetch_add(1);
+        value = 2 * attrs->cob().timepointToLocalTime().tm_mday;
+    }
+    std::optional<std::string> saveResult() const override { return std::to_string(value); }
+    bool restoreResult(std::string_view bytes) override {
+        value = std::stoi(std::string(bytes));
+        return true;
+    }
+    int value = 0;
+    std::atomic<int>& runs_;
+};
+
+std::filesystem::path freshDirectory(const std::string& name) {
+    auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+} // namespace
+
+TEST(ResultCacheTest, LeastRecentlyUsedEvictionAndReload) {
+    const auto dir = freshDirectory("eden_result_cache_lru");
+    const std::string payload(40, 'x');
+    {
+        eden::ResultCache cache(dir, 100);
+        cache.put(1, payload);
+        cache.put(2, payload);
+        EXPECT_TRUE(cache.get(1).has_value());  // 2 is now the oldest
+        cache.put(3, payload);
+
+        EXPECT_TRUE(cache.contains(1));
+        EXPECT_FALSE(cache.contains(2));
+        EXPECT_EQ(*cache.get(3), payload);
+        EXPECT_FALSE(cache.get(2).has_value());
+
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.entries, 2u);
+        EXPECT_EQ(stats.bytes, 80u);
+        EXPECT_EQ(stats.evictions, 1u);
+        EXPECT_EQ(stats.hits, 2u);
+        EXPECT_EQ(stats.misses, 1u);
+
+        // Larger than the whole cache: not kept
+        cache.put(4, std::string(101, 'y'));
+        EXPECT_FALSE(cache.contains(4));
+    }
+
+    // Entries survive the process, and a smaller bound evicts on reload
+    eden::ResultCache reopened(dir, 100);
+    EXPECT_EQ(reopened.stats().entries, 2u);
+    EXPECT_EQ(*reopened.get(1), payload);
+    eden::ResultCache smaller(dir, 50);
+    EXPECT_EQ(smaller.stats().entries, 1u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WorkflowTest, ResultCacheSkipsTasksAcrossWorkflows) {
+    const auto dir = freshDirectory("eden_result_cache_workflow");
+    auto cache = std::make_shared<eden::ResultCache>(dir, 1 << 20);
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+    std::atomic<int> runs{0};
+    eden::ThreadPool pool(2);
+
+    auto runOnce = [&](const eden::DateTime& cob) {
+        eden::Workflow wf("Overnight", std::make_shared<eden::Attributes>(cob), ctx);
+        auto task = std::make_shared<CachedTask>(1, runs);
+        wf.addTask(1, task);
+        wf.addTask(2, std::make_shared<CountingTask>(2, runs));
+        wf.dependsOn(2, 1);
+        wf.setResultCache(cache);
+        wf.run(pool);
+        return task->value;
+    };
+
+    EXPECT_EQ(runOnce(eden::DateTime(2024, 6, 3)), 6);
+    EXPECT_EQ(runs.load(), 2);
+
+    // Same inputs in another workflow: the cached value is restored, only the
+    // task that does not cache runs
+    EXPECT_EQ(runOnce(eden::DateTime(2024, 6, 3)), 6);
+    EXPECT_EQ(runs.load(), 3);
+
+    // Another COB is another key
+    EXPECT_EQ(runOnce(eden::DateTime(2024, 6, 4)), 8);
+    EXPECT_EQ(runs.load(), 5);
+    EXPECT_EQ(cache->stats().entries, 2u);
+
+    std::filesystem::remove_all(dir);
+}
+
+namespace {
+
+struct FlakyTask : eden::ITask {
+    FlakyTask(eden::TaskID id, std::atomic<bool>& fail, std::atomic<int>& runs)
+        : eden::ITask(id, "Flaky", 0, 0), fail_(fail), runs_(runs) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {
+        runs_.fetch_add(1);
+        if (fail_.load()) throw std::runtime_error("market data not ready");
+    }
+    std::atomic<bool>& fail_;
+    std::atomic<int>& runs_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, ResumeRunsOnlyTasksNotCompleted) {
+    const auto dir = freshDirectory("eden_checkpoint");
+    std::filesystem::create_directories(dir);
+    const auto journal = dir / "run.journal";
+    auto cache = std::make_shared<eden::ResultCache>(dir / "cache", 1 << 20);
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<bool> fail{true};
+    std::atomic<int> cachedRuns{0};
+    std::atomic<int> flakyRuns{0};
+    std::atomic<int> downstreamRuns{0};
+
+    // A fresh workflow each time, as after a restart: 1 (cached) -> 2 (flaky) -> 3, and 4 alone
+    auto build = [&] {
+        auto wf = std::make_unique<eden::Workflow>("Overnight", attr, ctx);
+        wf->addTask(1, std::make_shared<CachedTask>(1, cachedRuns));
+        wf->addTask(2, std::make_shared<FlakyTask>(2, fail, flakyRuns));
+        wf->addTask(3, std::make_shared<CountingTask>(3, downstreamRuns));
+        wf->addTask(4, std::make_shared<CountingTask>(4, downstreamRuns));
+        wf->dependsOn(2, 1);
+        wf->dependsOn(3, 2);
+        wf->setResultCache(cache);
+        wf->setCheckpoint(journal);
+        return wf;
+    };
+
+    eden::ThreadPool pool(2);
+    auto first = build();
+    EXPECT_THROW(first->run(pool), std::runtime_error);
+    EXPECT_EQ(cachedRuns.load(), 1);
+    EXPECT_EQ(flakyRuns.load(), 1);
+    EXPECT_EQ(downstreamRuns.load(), 1);  // task 4
+
+    const auto entries = eden::RunJournal::load(journal);
+    EXPECT_EQ(entries.size(), 2u);
+    EXPECT_TRUE(entries.contains(1));
+    EXPECT_TRUE(entries.at(1).result.has_value());
+    EXPECT_TRUE(entries.contains(4));
+
+    // Restart: tasks 1 and 4 are skipped. Task 2 reads the output of task 1, whose
+    // result comes back from the cache.
+    fail = false;
+    auto second = build();
+    second->resume(pool);
+    EXPECT_EQ(cachedRuns.load(), 1);
+    EXPECT_EQ(flakyRuns.load(), 2);
+    EXPECT_EQ(downstreamRuns.load(), 2);  // task 3
+    EXPECT_EQ(std::dynamic_pointer_cast<CachedTask>(second->tasks().at(1))->value, 6);
+    for (int id = 1; id <= 4; ++id) EXPECT_EQ(second->statusOf(id), eden::ITask::Status::Completed);
+
+    // Everything is journaled now: nothing runs
+    second->resume(pool);
+    EXPECT_EQ(cachedRuns.load(), 1);
+    EXPECT_EQ(flakyRuns.load(), 2);
+    EXPECT_EQ(downstreamRuns.load(), 2);
+    for (int id = 1; id <= 4; ++id) EXPECT_EQ(second->statusOf(id), eden::ITask::Status::Completed);
+
+    // Without a journal there is nothing to resume
+    eden::Workflow plain("Plain", attr, ctx);
+    EXPECT_THROW(plain.resume(pool), std::logic_error);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WorkflowTest, ResumeAfterATornJournalLine) {
+    const auto dir = freshDirectory("eden_torn_journal");
+    std::filesystem::create_directories(dir);
+    const auto journal = dir / "run.journal";
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<bool> fail{true};
+    std::atomic<int> flakyRuns{0};
+    std::atomic<int> downstreamRuns{0};
+
+    // 1 -> 2 (flaky) -> 3. Task 2 does not read the output of task 1, so resuming
+    // does not need task 1 to republish it (there is no result cache to restore it from).
+    auto build = [&] {
+        auto wf = std::make_unique<eden::Workflow>("Overnight", attr, ctx);
+        wf->addTask(1, std::make_shared<CountingTask>(1, downstreamRuns, 0, 101));
+        wf->addTask(2, std::make_shared<FlakyTask>(2, fail, flakyRuns));
+        wf->addTask(3, std::make_shared<CountingTask>(3, downstreamRuns));
+        wf->dependsOn(2, 1);
+        wf->dependsOn(3, 2);
+        wf->setCheckpoint(journal);
+        return wf;
+    };
+
+    eden::ThreadPool pool(2);
+    EXPECT_THROW(build()->run(pool), std::runtime_error);
+    EXPECT_EQ(downstreamRuns.load(), 1);
+
+    // The process died halfway through writing a line
+    {
+        std::ofstream out(journal, std::ios::app);
+        out << R"({"task":2,"finger)";
+    }
+
+    fail = false;
+    build()->resume(pool);
+    EXPECT_EQ(flakyRuns.load(), 2);
+    EXPECT_EQ(downstreamRuns.load(), 2);
+
+    // The entries written by the first resume were not glued onto the torn line
+    const auto entries = eden::RunJournal::load(journal);
+    EXPECT_EQ(entries.size(), 3u);
+
+    build()->resume(pool);
+    EXPECT_EQ(flakyRuns.load(), 2);
+    EXPECT_EQ(downstreamRuns.load(), 2);
+
+    std::filesystem::remove_all(dir);
+}
+
+namespace {
+
+// Fails its first `failures` attempts
+struct CountdownTask : eden::ITask {
+    CountdownTask(eden::TaskID id, int failures, std::atomic<int>& runs)
+        : eden::ITask(id, "Countdown", 0, 0), failures_(failures), runs_(runs) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {
+        runs_.fetch_add(1);
+        if (failures_.fetch_sub(1) > 0) throw std::runtime_error("transient");
+    }
+    std::atomic<int> failures_;
+    std::atomic<int>& runs_;
+};
+
+// Waits until stopped (or 5 s)
+struct HangingTask : eden::ITask {
+    HangingTask(eden::TaskID id, std::atomic<int>& runs) : eden::ITask(id, "Hanging", 0, 0), runs_(runs) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void runCancellable(const eden::AttributeSPtr&, const eden::ContextSPtr&, std::stop_token stop) override {
+        runs_.fetch_add(1);
+        const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!stop.stop_requested() && std::chrono::steady_clock::now() < giveUp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    std::atomic<int>& runs_;
+};
+
+} // namespace
+
+TEST(TaskPolicyTest, ExponentialBackoffIsCapped) {
+    using namespace std::chrono_literals;
+    eden::TaskPolicy policy;
+    policy.backoff = 10ms;
+    policy.maxBackoff = 50ms;
+    EXPECT_EQ(policy.backoffAfter(1), 10ms);
+    EXPECT_EQ(policy.backoffAfter(2), 20ms);
+    EXPECT_EQ(policy.backoffAfter(3), 40ms);
+    EXPECT_EQ(policy.backoffAfter(4), 50ms);
+    EXPECT_EQ(policy.backoffAfter(40), 50ms);
+
+    eden::FetchDataTask task(1, "T", 0, 0);
+    EXPECT_THROW(task.setPolicy(eden::TaskPolicy{.maxAttempts = 0}), std::invalid_argument);
+}
+
+TEST(WorkflowTest, TransientFailuresAreRetriedWithBackoff) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<int> flaky{0};
+    std::atomic<int> downstream{0};
+    eden::Workflow wf("Retry", attr, ctx);
+    auto task = std::make_shared<CountdownTask>(1, 2, flaky);
+    task->setPolicy({.maxAttempts = 3, .backoff = 5ms});
+    wf.addTask(1, task);
+    wf.addTask(2, std::make_shared<CountingTask>(2, downstream));
+    wf.dependsOn(2, 1);
+
+    eden::ThreadPool pool(2);
+    const auto start = std::chrono::steady_clock::now();
+    wf.run(pool);
+    // Two failures, then success; the backoff was waited on a timer (5 + 10 ms)
+    EXPECT_EQ(flaky.load(), 3);
+    EXPECT_EQ(downstream.load(), 1);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 15ms);
+
+    // Out of attempts: the last error reaches run()
+    auto broken = std::make_shared<CountdownTask>(3, 10, flaky);
+    broken->setPolicy({.maxAttempts = 2});
+    eden::Workflow failing("Failing", attr, ctx);
+    failing.addTask(3, broken);
+    flaky = 0;
+    EXPECT_THROW(failing.run(pool), std::runtime_error);
+    EXPECT_EQ(flaky.load(), 2);
+}
+
+namespace {
+
+// Inline, with timers that drop every job as a ThreadPool being destroyed does
+struct RefusingTimersExecutor : RecordingExecutor {
+    bool hasTimers() const noexcept override { return true; }
+    eden::TimerId enqueueAfter(std::chrono::nanoseconds /*delay*/, eden::Job /*job*/) override { return 0; }
+};
+
+} // namespace
+
+TEST(WorkflowTest, RetryDroppedByTheExecutorFailsTheTask) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<int> flaky{0};
+    std::atomic<int> downstream{0};
+    eden::Workflow wf("Dropped", attr, ctx);
+    auto task = std::make_shared<CountdownTask>(1, 1, flaky);
+    task->setPolicy({.maxAttempts = 3, .backoff = 5ms});
+    wf.addTask(1, task);
+    wf.addTask(2, std::make_shared<CountingTask>(2, downstream));
+    wf.dependsOn(2, 1);
+
+    // The retry never gets a timer: the run completes with the first failure
+    RefusingTimersExecutor executor;
+    EXPECT_THROW(wf.run(executor), std::runtime_error);
+    EXPECT_EQ(flaky.load(), 1);
+    EXPECT_EQ(downstream.load(), 0);
+    EXPECT_EQ(wf.statusOf(1), eden::ITask::Status::Failed);
+}
+
+TEST(WorkflowTest, DeadlineStopsRetries) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<int> runs{0};
+    auto task = std::make_shared<CountdownTask>(1, 1000, runs);
+    task->setPolicy({.maxAttempts = 1000, .backoff = 10ms, .backoffFactor = 1.0, .deadline = 60ms});
+    eden::Workflow wf("Deadline", attr, ctx);
+    wf.addTask(1, task);
+
+    eden::ThreadPool pool(1);
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_GE(runs.load(), 2);
+    EXPECT_LE(runs.load(), 7);
+}
+
+TEST(WorkflowTest, TimeoutRequestsStopAndFailsTheAttempt) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    std::atomic<int> runs{0};
+    auto task = std::make_shared<HangingTask>(1, runs);
+    task->setPolicy({.maxAttempts = 2, .timeout = 20ms});
+    eden::Workflow wf("Timeout", attr, ctx);
+    wf.addTask(1, task);
+
+    eden::ThreadPool pool(2);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(wf.run(pool), eden::TaskTimeoutError);
+    EXPECT_EQ(runs.load(), 2);
+    // Both attempts were stopped long before the task would have given up
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+}
+
+namespace {
+
+struct FnTask : eden::ITask {
+    FnTask(eden::TaskID id, std::function<void(std::stop_token)> body)
+        : eden::ITask(id, "Fn", 0, 0), body_(std::move(body)) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override { body_({}); }
+    void runCancellable(const eden::AttributeSPtr&, const eden::ContextSPtr&, std::stop_token stop) override {
+        body_(std::move(stop));
+    }
+    std::function<void(std::stop_token)> body_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, FailureSkipsDescendantsAndKeepsIndependentBranches) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 -> 2 (fails) -> 3 -> 4, and 5 on its own
+    std::atomic<int> runs{0};
+    eden::Workflow wf("FailFast", attr, ctx);
+    wf.addTask(1, std::make_shared<CountingTask>(1, runs));
+    wf.addTask(2, std::make_shared<ThrowingTask>(2, "Broken", 0, 0));
+    wf.addTask(3, std::make_shared<CountingTask>(3, runs));
+    wf.addTask(4, std::make_shared<CountingTask>(4, runs));
+    wf.addTask(5, std::make_shared<CountingTask>(5, runs));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 2);
+    wf.dependsOn(4, 3);
+
+    eden::ThreadPool pool(2);
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_EQ(runs.load(), 2);
+
+    using Status = eden::ITask::Status;
+    EXPECT_EQ(wf.statusOf(1), Status::Completed);
+    EXPECT_EQ(wf.statusOf(2), Status::Failed);
+    EXPECT_EQ(wf.statusOf(3), Status::Skipped);
+    EXPECT_EQ(wf.statusOf(4), Status::Skipped);
+    EXPECT_EQ(wf.statusOf(5), Status::Completed);
+    EXPECT_EQ(wf.tasks().at(3)->statusString(), "Skipped");
+}
+
+TEST(WorkflowTest, AbortRunCancelsTasksInFlight) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 runs until stopped, 2 fails once 1 is running, 3 waits for 1
+    std::atomic<bool> longRunning{false};
+    std::atomic<int> runs{0};
+    eden::Workflow wf("Abort", attr, ctx);
+    wf.addTask(1, std::make_shared<FnTask>(1, [&](std::stop_token stop) {
+        longRunning = true;
+        const auto giveUp = std::chrono::steady_clock::now() + 5s;
+        while (!stop.stop_requested() && std::chrono::steady_clock::now() < giveUp) std::this_thread::sleep_for(1ms);
+    }));
+    wf.addTask(2, std::make_shared<FnTask>(2, [&](std::stop_token) {
+        while (!longRunning) std::this_thread::yield();
+        throw std::runtime_error("bad market data");
+    }));
+    wf.addTask(3, std::make_shared<CountingTask>(3, runs));
+    wf.dependsOn(3, 1);
+    wf.setFailureMode(eden::FailureMode::AbortRun);
+
+    eden::ThreadPool pool(2);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+
+    using Status = eden::ITask::Status;
+    EXPECT_EQ(wf.statusOf(1), Status::Skipped);
+    EXPECT_EQ(wf.statusOf(2), Status::Failed);
+    EXPECT_EQ(wf.statusOf(3), Status::Skipped);
+    EXPECT_EQ(runs.load(), 0);
+}
+
+TEST(WorkflowTest, ConcurrentRunsOfOneWorkflowAreIsolated) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // Diamond: 1 -> {2, 3} -> 4
+    std::atomic<int> runs{0};
+    eden::Workflow wf("Concurrent", attr, ctx);
+    for (eden::TaskID id = 1; id <= 4; ++id) wf.addTask(id, std::make_shared<CountingTask>(id, runs));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 1);
+    wf.dependsOn(4, 2);
+    wf.dependsOn(4, 3);
+
+    eden::ThreadPool pool(2);
+    std::vector<eden::WorkflowRunSPtr> inFlight;
+    for (int i = 0; i < 8; ++i) inFlight.push_back(wf.runAsync(pool));
+    for (auto& run : inFlight) {
+        run->completion().get();
+        EXPECT_TRUE(run->done());
+        const auto progress = run->progress();
+        EXPECT_EQ(progress.total, 4u);
+        EXPECT_EQ(progress.completed, 4u);
+        EXPECT_TRUE(progress.finished());
+        EXPECT_EQ(run->status(4), eden::ITask::Status::Completed);
+    }
+    EXPECT_EQ(runs.load(), 32);
+
+    // A checkpoint journal belongs to one run at a time
+    const auto dir = std::filesystem::temp_directory_path() / "eden_concurrent_runs";
+    std::filesystem::create_directories(dir);
+    wf.setCheckpoint(dir / "journal.jsonl");
+    std::atomic<bool> release{false};
+    wf.addTask(5, std::make_shared<FnTask>(5, [&](std::stop_token) {
+        while (!release) std::this_thread::yield();
+    }));
+    auto first = wf.runAsync(pool);
+    EXPECT_THROW((void)wf.runAsync(pool), std::logic_error);
+    release = true;
+    first->wait();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WorkflowTest, CancelStopsTheRunAndSkipsTheRest) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 runs until stopped, 2 waits for it
+    std::atomic<int> runs{0};
+    eden::Workflow wf("Cancel", attr, ctx);
+    wf.addTask(1, std::make_shared<FnTask>(1, [](std::stop_token stop) {
+        const auto giveUp = std::chrono::steady_clock::now() + 5s;
+        while (!stop.stop_requested() && std::chrono::steady_clock::now() < giveUp) std::this_thread::sleep_for(1ms);
+    }));
+    wf.addTask(2, std::make_shared<CountingTask>(2, runs));
+    wf.dependsOn(2, 1);
+
+    eden::ThreadPool pool(2);
+    auto run = wf.runAsync(pool);
+    while (run->status(1) != eden::ITask::Status::Running) std::this_thread::yield();
+    auto progress = run->progress();
+    EXPECT_EQ(progress.running, 1u);
+    EXPECT_EQ(progress.pending, 1u);
+    EXPECT_FALSE(run->done());
+
+    const auto start = std::chrono::steady_clock::now();
+    run->cancel();
+    EXPECT_THROW(run->wait(), eden::RunCancelledError);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    EXPECT_TRUE(run->cancelled());
+
+    progress = run->progress();
+    EXPECT_EQ(progress.skipped, 2u);
+    EXPECT_TRUE(progress.finished());
+    EXPECT_EQ(runs.load(), 0);
+    // The blocking run() is the one that publishes statuses into the tasks
+    EXPECT_EQ(wf.statusOf(2), eden::ITask::Status::Pending);
+}
+
+TEST(WorkflowTest, StoppingTheRunDropsRetriesWaitingForTheirBackoff) {
+    using namespace std::chrono_literals;
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 fails and would retry in 30 s, 2 waits for it
+    std::atomic<int> flaky{0};
+    std::atomic<int> downstream{0};
+    eden::Workflow wf("Backoff", attr, ctx);
+    auto task = std::make_shared<CountdownTask>(1, 10, flaky);
+    task->setPolicy({.maxAttempts = 3, .backoff = 30s});
+    wf.addTask(1, task);
+    wf.addTask(2, std::make_shared<CountingTask>(2, downstream));
+    wf.dependsOn(2, 1);
+
+    eden::ThreadPool pool(2);
+    auto run = wf.runAsync(pool);
+    while (flaky.load() == 0 || run->status(1) != eden::ITask::Status::Pending) std::this_thread::yield();
+    const auto start = std::chrono::steady_clock::now();
+    run->cancel();
+    EXPECT_THROW(run->wait(), eden::RunCancelledError);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    EXPECT_EQ(run->progress().skipped, 2u);
+    EXPECT_EQ(flaky.load(), 1);
+    EXPECT_EQ(downstream.load(), 0);
+
+    // AbortRun: 3 fails for good while 1 waits for its retry
+    flaky = 0;
+    wf.addTask(3, std::make_shared<FnTask>(3, [&](std::stop_token) {
+        while (flaky.load() == 0) std::this_thread::yield();
+        std::this_thread::sleep_for(10ms);
+        throw std::runtime_error("bad market data");
+    }));
+    wf.setFailureMode(eden::FailureMode::AbortRun);
+    const auto aborted = std::chrono::steady_clock::now();
+    EXPECT_THROW(wf.run(pool), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - aborted, 2s);
+    EXPECT_EQ(wf.statusOf(1), eden::ITask::Status::Skipped);
+    EXPECT_EQ(wf.statusOf(3), eden::ITask::Status::Failed);
+    EXPECT_EQ(flaky.load(), 1);
+}
+
+namespace {
+
+// Remembers the scenarios it ran for
+struct ScenarioEchoTask : eden::ITask {
+    explicit ScenarioEchoTask(eden::TaskID id) : eden::ITask(id, "Echo", 0, 0) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr& attrs, const eden::ContextSPtr&) override {
+        const auto scenario = std::dynamic_pointer_cast<eden::ScenarioTask>(attrs);
+        std::lock_guard lock(mutex_);
+        seen_.insert(scenario ? scenario->getScenario() : "");
+    }
+    std::mutex mutex_;
+    std::set<std::string> seen_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, ScenarioFanOutRunsTheSharedPrefixOnce) {
+    const auto cob = eden::DateTime(2024, 6, 3);
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 (market data) -> 2 (calibration) -> 4 (PV) <- 3 (shock), 4 -> 5 (report)
+    // 1 and 2 ignore the scenario
+    std::array<std::atomic<int>, 8> runs{};
+    auto echo = std::make_shared<ScenarioEchoTask>(5);
+    eden::Workflow wf("Stress", std::make_shared<eden::Attributes>(cob), ctx);
+    for (eden::TaskID id = 1; id <= 4; ++id) wf.addTask(id, std::make_shared<TallyTask>(id, std::vector<std::string>{}, runs));
+    wf.addTask(5, echo);
+    wf.tasks().at(1)->setScenarioIndependent(true);
+    wf.tasks().at(2)->setScenarioIndependent(true);
+    wf.dependsOn(2, 1);
+    wf.dependsOn(4, 2);
+    wf.dependsOn(4, 3);
+    wf.dependsOn(5, 4);
+
+    std::vector<eden::AttributeSPtr> scenarios;
+    for (const char* name : {"base", "rates+100", "fx-10", "credit+50"}) {
+        scenarios.push_back(std::make_shared<eden::ScenarioTask>(cob, name));
+    }
+
+    eden::ThreadPool pool(2);
+    const auto fanOut = wf.runScenarios(pool, scenarios);
+    EXPECT_EQ(runs[1].load(), 1);
+    EXPECT_EQ(runs[2].load(), 1);
+    EXPECT_EQ(runs[3].load(), 4);
+    EXPECT_EQ(runs[4].load(), 4);
+    EXPECT_EQ(echo->seen_, (std::set<std::string>{"base", "credit+50", "fx-10", "rates+100"}));
+
+    auto dependent = fanOut.dependentTasks;
+    std::sort(dependent.begin(), dependent.end());
+    EXPECT_EQ(dependent, (std::vector<eden::TaskID>{3, 4, 5}));
+
+    using Status = eden::ITask::Status;
+    EXPECT_EQ(fanOut.shared->status(2), Status::Completed);
+    EXPECT_EQ(fanOut.shared->status(3), Status::Skipped);
+    ASSERT_EQ(fanOut.scenarios.size(), 4u);
+    for (const auto& run : fanOut.scenarios) {
+        EXPECT_NO_THROW(run->completion().get());
+        EXPECT_EQ(run->status(1), Status::Completed);
+        EXPECT_EQ(run->status(5), Status::Completed);
+        EXPECT_EQ(run->progress().completed, 5u);
+    }
+
+    // Different COBs: nothing is shared
+    const auto byCob = wf.runScenarios(pool, {std::make_shared<eden::Attributes>(cob),
+                                              std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 4))});
+    EXPECT_EQ(byCob.dependentTasks.size(), 5u);
+    EXPECT_EQ(runs[1].load(), 3);
+    EXPECT_THROW(wf.runScenarios(pool, {}), std::invalid_argument);
+}
+
+namespace {
+
+struct DataTask : eden::ITask {
+    DataTask(eden::TaskID id, int input, int output, std::function<void(DataTask&, eden::ArtifactStore&)> body)
+        : eden::ITask(id, "Data", input, output), body_(std::move(body)) {}
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void runWithArtifacts(const eden::AttributeSPtr&, const eden::ContextSPtr&, std::stop_token,
+                          eden::ArtifactStore& artifacts) override {
+        body_(*this, artifacts);
+    }
+    std::function<void(DataTask&, eden::ArtifactStore&)> body_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, ResumeRerunsProducersWhoseArtifactsAreRead) {
+    const auto dir = freshDirectory("eden_resume_artifacts");
+    std::filesystem::create_directories(dir);
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 publishes 11, read by 2; 3 publishes 31 that nobody reads. No result cache.
+    std::atomic<int> runs[4]{};
+    std::atomic<bool> fail{true};
+    std::atomic<double> priced{0.0};
+    auto build = [&] {
+        auto wf = std::make_unique<eden::Workflow>("Resume", attr, ctx);
+        wf->addTask(1, std::make_shared<DataTask>(1, 0, 11, [&](DataTask& self, eden::ArtifactStore& artifacts) {
+            runs[1].fetch_add(1);
+            artifacts.publish(self.outputID(), 1.5);
+        }));
+        wf->addTask(2, std::make_shared<DataTask>(2, 11, 21, [&](DataTask& self, eden::ArtifactStore& artifacts) {
+            runs[2].fetch_add(1);
+            if (fail.load()) throw std::runtime_error("pricer failed");
+            priced = *artifacts.get<double>(self.inputID()) + 1;
+            artifacts.publish(self.outputID(), priced.load());
+        }));
+        wf->addTask(3, std::make_shared<DataTask>(3, 0, 31, [&](DataTask& self, eden::ArtifactStore& artifacts) {
+            runs[3].fetch_add(1);
+            artifacts.publish(self.outputID(), 3.0);
+        }));
+        wf->dependsOn(2, 1);
+        wf->setCheckpoint(dir / "run.journal");
+        return wf;
+    };
+    eden::ThreadPool pool(2);
+    EXPECT_THROW(build()->run(pool), std::runtime_error);
+
+    // 2 needs the curve this process does not have: 1 runs again, 3 does not
+    fail = false;
+    auto second = build();
+    second->resume(pool);
+    EXPECT_EQ(runs[1].load(), 2);
+    EXPECT_EQ(runs[2].load(), 2);
+    EXPECT_EQ(runs[3].load(), 1);
+    EXPECT_EQ(priced.load(), 2.5);
+
+    // Nothing left to run, so nothing is needed
+    second->resume(pool);
+    EXPECT_EQ(runs[1].load(), 2);
+    EXPECT_EQ(runs[2].load(), 2);
+    EXPECT_EQ(runs[3].load(), 1);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WorkflowTest, ArtifactsFlowBetweenTasksWithoutCopies) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 publishes a curve (11); 2 and 3 read it and publish 21 and 22; 4 reads 21, publishes 31
+    std::atomic<const void*> curve{nullptr};
+    std::atomic<int> sameObject{0};
+    const auto sum = [&](DataTask& self, eden::ArtifactStore& artifacts) {
+        auto input = artifacts.get<std::vector<double>>(self.inputID());
+        if (input.get() == curve.load()) ++sameObject;
+        double total = 0;
+        for (double v : *input) total += v;
+        artifacts.publish(self.outputID(), std::vector<double>{total});
+    };
+
+    eden::Workflow wf("Dataflow", attr, ctx);
+    wf.addTask(1, std::make_shared<DataTask>(1, 0, 11, [&](DataTask& self, eden::ArtifactStore& artifacts) {
+        curve = artifacts.publish(self.outputID(), std::vector<double>(1000, 0.5)).get();
+    }));
+    wf.addTask(2, std::make_shared<DataTask>(2, 11, 21, sum));
+    wf.addTask(3, std::make_shared<DataTask>(3, 11, 22, sum));
+    wf.addTask(4, std::make_shared<DataTask>(4, 21, 31, sum));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 1);
+    wf.dependsOn(4, 2);
+
+    eden::ThreadPool pool(2);
+    auto run = wf.runAsync(pool);
+    run->wait();
+    EXPECT_EQ(sameObject.load(), 2);
+
+    // Intermediates went with their last consumer, the outputs stay
+    const auto artifacts = run->artifacts();
+    EXPECT_FALSE(artifacts->contains(11));
+    EXPECT_FALSE(artifacts->contains(21));
+    EXPECT_EQ(artifacts->get<std::vector<double>>(22)->front(), 500.0);
+    EXPECT_EQ(artifacts->get<std::vector<double>>(31)->front(), 500.0);
+    EXPECT_EQ(artifacts->stats().released, 2u);
+}
+
+namespace {
+
+// Publishes the COB day as artifact 11. The result can be cached, and a restored
+// result is published again.
+struct CurveTask : eden::ITask {
+    CurveTask(eden::TaskID id, std::atomic<int>& runs) : eden::ITask(id, "Curve", 0, 11), runs_(runs) {
+        setContextKeys({"curve"});
+    }
+    void prepare(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void run(const eden::AttributeSPtr&, const eden::ContextSPtr&) override {}
+    void runWithArtifacts(const eden::AttributeSPtr& attrs, const eden::ContextSPtr&, std::stop_token,
+                          eden::ArtifactStore& artifacts) override {
+        runs_.fetch_add(1);
+        value = attrs->cob().timepointToLocalTime().tm_mday;
+        artifacts.publish(outputID(), value);
+    }
+    std::optional<std::string> saveResult() const override { return std::to_string(value); }
+    bool restoreWithArtifacts(std::string_view bytes, eden::ArtifactStore& artifacts) override {
+        artifacts.publish(outputID(), std::stod(std::string(bytes)));
+        return true;
+    }
+    double value = 0.0;
+    std::atomic<int>& runs_;
+};
+
+} // namespace
+
+TEST(WorkflowTest, ReusedTasksStillProvideTheirArtifacts) {
+    const auto dir = freshDirectory("eden_reused_artifacts");
+    std::filesystem::create_directories(dir);
+    auto cache = std::make_shared<eden::ResultCache>(dir / "cache", 1 << 20);
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    auto ctx = std::make_shared<eden::JsonContext>();
+    ctx->set("curve", 1);
+    ctx->set("spread", 1);
+
+    // 1 publishes the curve (11), 2 reads it; only 2 reads the spread
+    std::atomic<int> curveRuns{0};
+    std::atomic<int> pricerRuns{0};
+    std::atomic<bool> fail{false};
+    std::atomic<double> seen{0.0};
+    auto build = [&](const std::string& name) {
+        auto wf = std::make_unique<eden::Workflow>(name, attr, ctx);
+        wf->addTask(1, std::make_shared<CurveTask>(1, curveRuns));
+        auto pricer = std::make_shared<DataTask>(2, 11, 21, [&](DataTask& self, eden::ArtifactStore& artifacts) {
+            pricerRuns.fetch_add(1);
+            if (fail.load()) throw std::runtime_error("pricer failed");
+            seen = *artifacts.get<double>(self.inputID());
+            artifacts.publish(self.outputID(), seen.load() + 1);
+        });
+        pricer->setContextKeys({"spread"});
+        wf->addTask(2, pricer);
+        wf->dependsOn(2, 1);
+        wf->setResultCache(cache);
+        return wf;
+    };
+    eden::ThreadPool pool(2);
+
+    // Incremental: the curve is reused, and so is its artifact, run after run
+    auto intraday = build("Intraday");
+    intraday->setIncremental(true);
+    intraday->run(pool);
+    EXPECT_EQ(curveRuns.load(), 1);
+    EXPECT_EQ(seen.load(), 3.0);
+    for (int spread = 2; spread <= 3; ++spread) {
+        ctx->set("spread", spread);
+        seen = 0.0;
+        intraday->run(pool);
+        EXPECT_EQ(curveRuns.load(), 1);
+        EXPECT_EQ(pricerRuns.load(), spread);
+        EXPECT_EQ(seen.load(), 3.0);
+    }
+
+    // Cache hit in another workflow: the restored curve is published for the pricer
+    seen = 0.0;
+    build("Overnight")->run(pool);
+    EXPECT_EQ(curveRuns.load(), 1);
+    EXPECT_EQ(pricerRuns.load(), 4);
+    EXPECT_EQ(seen.load(), 3.0);
+
+    // Resume after a failed pricer: the journaled curve comes back from the cache
+    fail = true;
+    auto first = build("Checkpointed");
+    first->setCheckpoint(dir / "run.journal");
+    EXPECT_THROW(first->run(pool), std::runtime_error);
+    fail = false;
+    seen = 0.0;
+    auto second = build("Checkpointed");
+    second->setCheckpoint(dir / "run.journal");
+    second->resume(pool);
+    EXPECT_EQ(curveRuns.load(), 1);
+    EXPECT_EQ(pricerRuns.load(), 6);
+    EXPECT_EQ(seen.load(), 3.0);
+    EXPECT_EQ(second->statusOf(2), eden::ITask::Status::Completed);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WorkflowTest, TargetedRunOnlyExecutesTheAncestorClosure) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // 1 -> 2 -> 3 (PV, output 30), 1 -> 4 (curve, output 40), 5 on its own
+    std::array<std::atomic<int>, 8> runs{};
+    const auto count = [&](DataTask& self, eden::ArtifactStore&) { ++runs[self.ID()]; };
+    eden::Workflow wf("Query", attr, ctx);
+    wf.addTask(1, std::make_shared<DataTask>(1, 0, 10, count));
+    wf.addTask(2, std::make_shared<DataTask>(2, 10, 20, count));
+    wf.addTask(3, std::make_shared<DataTask>(3, 20, 30, count));
+    wf.addTask(4, std::make_shared<DataTask>(4, 10, 40, count));
+    wf.addTask(5, std::make_shared<DataTask>(5, 0, 50, count));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 2);
+    wf.dependsOn(4, 1);
+
+    const auto counts = [&] {
+        std::vector<int> out;
+        for (int id = 1; id <= 5; ++id) out.push_back(runs[id].load());
+        return out;
+    };
+
+    eden::ThreadPool pool(2);
+    wf.run(pool, {.tasks = {3}});
+    EXPECT_EQ(counts(), (std::vector<int>{1, 1, 1, 0, 0}));
+    using Status = eden::ITask::Status;
+    EXPECT_EQ(wf.statusOf(3), Status::Completed);
+    EXPECT_EQ(wf.statusOf(4), Status::Skipped);
+    EXPECT_EQ(wf.statusOf(5), Status::Skipped);
+
+    wf.run(pool, {.outputs = {40}});
+    EXPECT_EQ(counts(), (std::vector<int>{2, 1, 1, 1, 0}));
+
+    // Incremental: what the target needs is already up to date
+    wf.setIncremental(true);
+    wf.run(pool, {.tasks = {3}});
+    wf.run(pool, {.tasks = {3}});
+    EXPECT_EQ(counts(), (std::vector<int>{3, 2, 2, 1, 0}));
+
+    EXPECT_THROW(wf.run(pool, {.tasks = {99}}), std::out_of_range);
+    EXPECT_THROW(wf.run(pool, {.outputs = {99}}), std::invalid_argument);
+    EXPECT_THROW(wf.run(pool, eden::RunTargets{}), std::invalid_argument);
+}
+
+TEST(WorkflowTest, LinearChainsRunFusedInOneJob) {
+    const eden::AttributeSPtr attr = std::make_shared<eden::Attributes>(eden::DateTime(2024, 6, 3));
+    const eden::ContextSPtr ctx = std::make_shared<eden::TaskContext>();
+
+    // Fetch -> Compute -> Save -> Report is one chain; 5 and 6 both feed 7, which is not fused
+    std::mutex mutex;
+    std::set<std::thread::id> chainThreads;
+    std::atomic<int> runs{0};
+    const auto onChain = [&](std::stop_token) {
+        std::lock_guard lock(mutex);
+        chainThreads.insert(std::this_thread::get_id());
+    };
+    eden::Workflow wf("Chain", attr, ctx);
+    for (eden::TaskID id = 1; id <= 4; ++id) wf.addTask(id, std::make_shared<FnTask>(id, onChain));
+    for (eden::TaskID id = 5; id <= 7; ++id) wf.addTask(id, std::make_shared<CountingTask>(id, runs));
+    wf.dependsOn(2, 1);
+    wf.dependsOn(3, 2);
+    wf.dependsOn(4, 3);
+    wf.dependsOn(7, 5);
+    wf.dependsOn(7, 6);
+
+    const auto compiled = wf.compile();
+    const auto& plan = *compiled;
+    EXPECT_EQ(plan.fusedEdges(), 3u);
+    EXPECT_EQ(plan.fusedChild(plan.indexOf(1)), plan.indexOf(2));
+    EXPECT_EQ(plan.fusedChild(plan.indexOf(5)), eden::ExecutionPlan::kNoTask);
+
+    // Roots 1, 5, 6 in one batch, 7 on its own; 2, 3 and 4 ride along with 1
+    RecordingExecutor executor;
+    wf.run(executor);
+    EXPECT_EQ(executor.singles, 1);
+    ASSERT_EQ(executor.batches.size(), 1u);
+    EXPECT_EQ(executor.batches[0], 3u);
+    for (eden::TaskID id = 1; id <= 7; ++id) EXPECT_EQ(wf.statusOf(id), eden::ITask::Status::Completed);
+
+    wf.setFusion(false);
+    RecordingExecutor unfused;
+    wf.run(unfused);
+    EXPECT_EQ(unfused.singles, 4);
+
+    // On a pool, the whole chain stays on one worker
+    wf.setFusion(true);
+    chainThreads.clear();
+    eden::ThreadPool pool(4);
+    wf.run(pool);
+    EXPECT_EQ(chainThreads.size(), 1u);
+    EXPECT_EQ(runs.load(), 9);
+
+    // A failure inside a chain still stops the rest of it, task by task
+    eden::Workflow broken("BrokenChain", attr, ctx);
+    broken.addTask(1, std::make_shared<CountingTask>(1, runs));
+    broken.addTask(2, std::make_shared<ThrowingTask>(2, "Broken", 0, 0));
+    broken.addTask(3, std::make_shared<CountingTask>(3, runs));
+    broken.dependsOn(2, 1);
+    broken.dependsOn(3, 2);
+    EXPECT_THROW(broken.run(pool), std::runtime_error);
+    EXPECT_EQ(broken.statusOf(1), eden::ITask::Status::Completed);
+    EXPECT_EQ(broken.statusOf(2), eden::ITask::Status::Failed);
+    EXPECT_EQ(broken.statusOf(3), eden::ITask::Status::Skipped);
+}